@@ -0,0 +1,560 @@
+// Benchmark suite comparing Lariat to std::vector, std::deque and std::list
+// usage: bench_lariat [repetitions] [output.json]
+// results are written as JSON (to stdout if no file is given)
+#include <fcntl.h> /* open */
+#include <sys/uio.h> /* writev */
+#include <unistd.h> /* write, close, unlink */
+
+#include <algorithm>
+#include <chrono>
+#include <climits> /* IOV_MAX */
+#include <cmath>
+#include <cstdio> /* sscanf */
+#include <cstdlib> /* mkstemp */
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+#include "lariat.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// container adapters - the same operation expressed for every container
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename T, int Size>
+void insert_at(Lariat<T, Size> &lar, int pos, T const &val) {
+  lar.insert(pos, val);
+}
+
+template<typename C>
+void insert_at(C &c, int pos, typename C::value_type const &val) {
+  c.insert(std::next(c.begin(), pos), val);
+}
+
+template<typename T, int Size>
+void erase_at(Lariat<T, Size> &lar, int pos) {
+  lar.erase(pos);
+}
+
+template<typename C>
+void erase_at(C &c, int pos) {
+  c.erase(std::next(c.begin(), pos));
+}
+
+template<typename T, int Size>
+T const &value_at(Lariat<T, Size> const &lar, int pos) {
+  return lar[pos];
+}
+
+template<typename C>
+typename C::value_type const &value_at(C const &c, int pos) {
+  return *std::next(c.begin(), pos);
+}
+
+template<typename T, int Size>
+size_t find_value(Lariat<T, Size> const &lar, T const &val) {
+  return lar.find(val);
+}
+
+template<typename C>
+size_t find_value(C const &c, typename C::value_type const &val) {
+  return static_cast<size_t>(std::distance(c.begin(), std::find(c.begin(), c.end(), val)));
+}
+
+template<typename C, typename V>
+void push_front_it(C &c, V const &val) {
+  c.push_front(val);
+}
+
+template<typename T>
+void push_front_it(std::vector<T> &v, T const &val) {
+  v.insert(v.begin(), val);
+}
+
+template<typename C>
+void pop_front_it(C &c) {
+  c.pop_front();
+}
+
+template<typename T>
+void pop_front_it(std::vector<T> &v) {
+  v.erase(v.begin());
+}
+
+template<typename T, int Size>
+void compact_it(Lariat<T, Size> &lar) {
+  lar.compact();
+}
+
+template<typename T>
+void compact_it(std::vector<T> &v) {
+  v.shrink_to_fit();
+}
+
+template<typename T>
+void compact_it(std::deque<T> &d) {
+  d.shrink_to_fit();
+}
+
+template<typename T>
+void compact_it(std::list<T> &) {}
+
+// containers with unused capacity, the input of compact
+template<typename C>
+void fill_sparse(C &c, int count) {
+  for (int i = 0; i < count; ++i) {
+    push_front_it(c, i);
+  }
+}
+
+template<typename T>
+void fill_sparse(std::vector<T> &v, int count) {
+  v.reserve(2 * static_cast<size_t>(count));
+  for (int i = 0; i < count; ++i) {
+    v.push_back(i);
+  }
+}
+
+template<typename C>
+void fill(C &c, int count) {
+  for (int i = 0; i < count; ++i) {
+    c.push_back(i);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// measurement
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Result {
+  std::string container;
+  std::string operation;
+  int elements;
+  int operations;
+  std::vector<double> ns_per_op; // one sample per repetition
+};
+
+std::vector<Result> results;
+volatile size_t sink; // keeps the optimizer from removing the measured work
+
+// setup is not timed, run performs "operations" operations on the container prepared by setup
+template<typename C>
+void measure(
+    std::string const &container,
+    std::string const &operation,
+    int elements,
+    int operations,
+    int repetitions,
+    std::function<void(C &)> const &setup,
+    std::function<void(C &)> const &run) {
+  Result result{container, operation, elements, operations, {}};
+
+  for (int rep = -1; rep < repetitions; ++rep) { // repetition -1 is the warmup
+    C c;
+    setup(c);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    run(c);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    sink = sink + c.size();
+    if (rep >= 0) {
+      std::chrono::duration<double, std::nano> elapsed = end - start;
+      result.ns_per_op.push_back(elapsed.count() / operations);
+    }
+  }
+
+  std::cerr << container << " " << operation << " " << elements << " done\n";
+  results.push_back(result);
+}
+
+template<typename C>
+void run_all(std::string const &container, int elements, int repetitions) {
+  const int ops = std::min(elements / 2, 1000);
+  const int find_ops = 100;
+
+  // the same positions and values for every container
+  std::mt19937 gen(2024);
+  std::vector<int> positions, values;
+  for (int i = 0; i < ops; ++i) {
+    positions.push_back(static_cast<int>(gen() % static_cast<unsigned>(elements - ops)));
+    values.push_back(static_cast<int>(gen() % static_cast<unsigned>(elements)));
+  }
+
+  auto filled = [elements](C &c) { fill(c, elements); };
+  auto sparse = [elements](C &c) { fill_sparse(c, elements); };
+
+  measure<C>(container, "insert", elements, ops, repetitions, filled, [&](C &c) {
+    for (int i = 0; i < ops; ++i) insert_at(c, positions[static_cast<size_t>(i)], i);
+  });
+  measure<C>(container, "erase", elements, ops, repetitions, filled, [&](C &c) {
+    for (int i = 0; i < ops; ++i) erase_at(c, positions[static_cast<size_t>(i)]);
+  });
+  measure<C>(container, "push_back", elements, elements, repetitions, [](C &) {}, [&](C &c) {
+    for (int i = 0; i < elements; ++i) c.push_back(i);
+  });
+  measure<C>(container, "push_front", elements, ops, repetitions, filled, [&](C &c) {
+    for (int i = 0; i < ops; ++i) push_front_it(c, i);
+  });
+  measure<C>(container, "pop_back", elements, elements, repetitions, filled, [&](C &c) {
+    for (int i = 0; i < elements; ++i) c.pop_back();
+  });
+  measure<C>(container, "pop_front", elements, ops, repetitions, filled, [&](C &c) {
+    for (int i = 0; i < ops; ++i) pop_front_it(c);
+  });
+  measure<C>(container, "operator[]", elements, ops, repetitions, filled, [&](C &c) {
+    for (int i = 0; i < ops; ++i) sink = sink + static_cast<size_t>(value_at(c, positions[static_cast<size_t>(i)]));
+  });
+  measure<C>(container, "find", elements, find_ops, repetitions, filled, [&](C &c) {
+    for (int i = 0; i < find_ops; ++i) sink = sink + find_value(c, values[static_cast<size_t>(i)]);
+  });
+  measure<C>(container, "compact", elements, 1, repetitions, sparse, [](C &c) { compact_it(c); });
+  measure<C>(container, "copy", elements, 1, repetitions, filled, [](C &c) {
+    C copy(c);
+    sink = sink + copy.size();
+  });
+}
+
+template<int Size>
+void run_lariat(int elements, int repetitions) {
+  run_all<Lariat<int, Size>>("Lariat<int," + std::to_string(Size) + ">", elements, repetitions);
+}
+
+// converting copy, reduce and transform of a large list on 1, 2, 4, ... threads up to at least 4
+void run_parallel(int elements, int repetitions) {
+  auto filled = [elements](Lariat<int, 512> &lar) { fill(lar, elements); };
+  unsigned most = std::max(4u, LariatParallel::threads());
+  for (unsigned threads = 1; threads <= most; threads *= 2) {
+    LariatParallel::threads(threads);
+    std::string container = "Lariat<int,512> " + std::to_string(threads) + " threads";
+    measure<Lariat<int, 512>>(container, "convert_copy", elements, 1, repetitions, filled, [](Lariat<int, 512> &lar) {
+      Lariat<float, 512> copy(lar);
+      sink = sink + copy.size();
+    });
+    measure<Lariat<int, 512>>(container, "reduce", elements, elements, repetitions, filled, [](Lariat<int, 512> &lar) {
+      sink = sink + static_cast<size_t>(lar.reduce(0LL, [](long long a, long long b) { return a + b; }));
+    });
+    measure<Lariat<int, 512>>(
+        container, "transform_inplace", elements, elements, repetitions, filled, [](Lariat<int, 512> &lar) {
+          lar.transform_inplace([](int value) { return 3 * value + 1; });
+        });
+  }
+  LariatParallel::threads(0);
+}
+
+// sorting a large list in place against copying it out, std::sort and rebuilding it
+void run_sort(int elements, int repetitions) {
+  using L = Lariat<int, 512>;
+  auto shuffled = [elements](L &lar) {
+    std::mt19937 gen(2024);
+    for (int i = 0; i < elements; ++i) lar.push_back(static_cast<int>(gen() % static_cast<unsigned>(elements)));
+  };
+
+  measure<L>("Lariat<int,512>", "sort", elements, elements, repetitions, shuffled, [](L &lar) { lar.sort(); });
+  measure<L>("Lariat<int,512>", "stable_sort", elements, elements, repetitions, shuffled, [](L &lar) {
+    lar.stable_sort();
+  });
+  measure<L>("Lariat<int,512>", "copy_sort_rebuild", elements, elements, repetitions, shuffled, [](L &lar) {
+    std::vector<int> v;
+    v.reserve(lar.size());
+    while (lar.size() > 0) {
+      v.push_back(lar.first());
+      lar.pop_front();
+    }
+    std::sort(v.begin(), v.end());
+    for (int value: v) lar.push_back(value);
+  });
+}
+
+// typing in the middle of a list with a backspace after every 3 characters, by index and through a cursor
+void run_cursor(int elements, int repetitions) {
+  using L = Lariat<int, 512>;
+  auto filled = [elements](L &lar) {
+    for (int i = 0; i < elements; ++i) lar.push_back(i);
+  };
+
+  const int edits = 100000;
+  const size_t middle = static_cast<size_t>(elements) / 2;
+  measure<L>("Lariat<int,512>", "edit_by_index", elements, edits, repetitions, filled, [middle](L &lar) {
+    size_t pos = middle;
+    for (int i = 0; i < edits; ++i) {
+      if (i % 4 == 3) {
+        lar.erase(--pos);
+      } else {
+        lar.insert(pos++, i);
+      }
+    }
+  });
+  measure<L>("Lariat<int,512>", "edit_by_cursor", elements, edits, repetitions, filled, [middle](L &lar) {
+    L::Cursor cursor = lar.cursor(middle);
+    for (int i = 0; i < edits; ++i) {
+      if (i % 4 == 3) {
+        cursor.advance(-1);
+        cursor.erase_here();
+      } else {
+        cursor.insert_here(i);
+      }
+    }
+  });
+}
+
+// editing and searching a text document in a Lariat<char, N>, std::string for reference
+void run_text(int elements, int repetitions) {
+  using L = Lariat<char, 4096>;
+  std::mt19937 gen(2024);
+  std::string document(static_cast<size_t>(elements), ' ');
+  for (char &c: document) c = gen() % 40 == 0 ? '\n' : static_cast<char>('a' + gen() % 26);
+
+  const int edits = 1000;
+  const std::string line(63, 'x');
+  std::vector<size_t> positions;
+  for (int i = 0; i < edits; ++i) positions.push_back(gen() % static_cast<unsigned>(elements));
+
+  auto filled = [&document](L &lar) { lar.insert(0, document); };
+  auto tracked = [&document](L &lar) {
+    lar.insert(0, document);
+    lar.track_lines(true);
+  };
+
+  measure<L>("Lariat<char,4096>", "insert_text", elements, edits, repetitions, filled, [&](L &lar) {
+    for (size_t pos: positions) lar.insert(pos, line);
+  });
+  measure<L>("Lariat<char,4096>", "insert_chars", elements, edits, repetitions, filled, [&](L &lar) {
+    for (size_t pos: positions) {
+      for (size_t i = 0; i < line.size(); ++i) lar.insert(pos + i, line[i]);
+    }
+  });
+  measure<L>("Lariat<char,4096>", "substr", elements, edits, repetitions, filled, [&](L &lar) {
+    for (size_t pos: positions) sink = sink + lar.substr(pos, 4096).size();
+  });
+  measure<L>("Lariat<char,4096>", "find", elements, elements, repetitions, filled, [](L &lar) {
+    sink = sink + lar.find("not in the document");
+  });
+  measure<L>("Lariat<char,4096>", "line_start", elements, edits, repetitions, filled, [&](L &lar) {
+    for (size_t pos: positions) sink = sink + lar.line_start(pos / 100);
+  });
+  measure<L>("Lariat<char,4096> track_lines", "line_start", elements, edits, repetitions, tracked, [&](L &lar) {
+    for (size_t pos: positions) sink = sink + lar.line_start(pos / 100);
+  });
+
+  auto string_filled = [&document](std::string &text) { text = document; };
+  measure<std::string>("std::string", "insert_text", elements, edits, repetitions, string_filled, [&](std::string &text) {
+    for (size_t pos: positions) text.insert(pos, line);
+  });
+  measure<std::string>("std::string", "find", elements, elements, repetitions, string_filled, [](std::string &text) {
+    sink = sink + text.find("not in the document");
+  });
+}
+
+// reading ranges element by element, with copy_out and as node pieces handed to writev
+void run_chunks(int elements, int repetitions) {
+  using L = Lariat<int, 512>;
+  auto filled = [elements](L &lar) {
+    for (int i = 0; i < elements; ++i) lar.push_back(i);
+  };
+
+  const size_t range = 4096;
+  std::mt19937 gen(2024);
+  std::vector<size_t> positions;
+  for (int i = 0; i < 100; ++i) positions.push_back(gen() % (static_cast<unsigned>(elements) - range));
+  const int copied = static_cast<int>(positions.size() * range);
+  std::vector<int> buffer(range);
+
+  measure<L>("Lariat<int,512>", "copy_by_index", elements, copied, repetitions, filled, [&](L &lar) {
+    for (size_t pos: positions) {
+      for (size_t i = 0; i < range; ++i) buffer[i] = lar[pos + i];
+      sink = sink + static_cast<size_t>(buffer[range - 1]);
+    }
+  });
+  measure<L>("Lariat<int,512>", "copy_out", elements, copied, repetitions, filled, [&](L &lar) {
+    for (size_t pos: positions) {
+      lar.copy_out(pos, range, buffer.data());
+      sink = sink + static_cast<size_t>(buffer[range - 1]);
+    }
+  });
+
+  // the whole list written to /dev/null, through a buffer and straight from the nodes
+  int null = open("/dev/null", O_WRONLY);
+  if (null < 0) {
+    return;
+  }
+  measure<L>("Lariat<int,512>", "write_copy_out", elements, elements, repetitions, filled, [&](L &lar) {
+    for (size_t pos = 0; pos < lar.size(); pos += range) {
+      size_t count = std::min(range, lar.size() - pos);
+      lar.copy_out(pos, count, buffer.data());
+      sink = sink + static_cast<size_t>(write(null, buffer.data(), count * sizeof(int)));
+    }
+  });
+  measure<L>("Lariat<int,512>", "writev_chunks", elements, elements, repetitions, filled, [&](L &lar) {
+    std::vector<iovec> pieces;
+    auto flush = [&]() {
+      sink = sink + static_cast<size_t>(writev(null, pieces.data(), static_cast<int>(pieces.size())));
+      pieces.clear();
+    };
+    lar.for_each_chunk(0, lar.size(), [&](const int *values, size_t count) {
+      pieces.push_back(iovec{const_cast<int *>(values), count * sizeof(int)});
+      if (pieces.size() == IOV_MAX) flush();
+    });
+    flush();
+  });
+  close(null);
+}
+
+// loading a text file of numbers with >> and push_back and with read_from, the file is written to /tmp first
+void run_ingest(int elements, int repetitions) {
+  using L = Lariat<int, 512>;
+  char path[] = "/tmp/lariat_ingest_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    return;
+  }
+
+  std::mt19937 gen(2024);
+  std::string text;
+  for (int i = 0; i < elements; ++i) {
+    text += std::to_string(static_cast<int>(gen() % 2000000000u) - 1000000000);
+    text += '\n';
+  }
+  bool written = write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+  close(fd);
+  std::cerr << "ingest file of " << text.size() << " bytes\n";
+
+  if (written) {
+    auto empty = [](L &) {};
+    measure<L>("Lariat<int,512>", "istream_push_back", elements, elements, repetitions, empty, [&path](L &lar) {
+      std::ifstream file(path);
+      int value;
+      while (file >> value) lar.push_back(value);
+    });
+    measure<L>("Lariat<int,512>", "read_from_istream", elements, elements, repetitions, empty, [&path](L &lar) {
+      std::ifstream file(path, std::ios::binary);
+      lar.read_from(file);
+    });
+    measure<L>("Lariat<int,512>", "read_from_fd", elements, elements, repetitions, empty, [&path](L &lar) {
+      int file = open(path, O_RDONLY);
+      lar.read_from(file);
+      close(file);
+    });
+  }
+  unlink(path);
+}
+
+// compress_cold on integer IDs: how much the packed nodes save and what accessing them costs
+void run_packed(int elements, int repetitions) {
+  using L = Lariat<int, 4096>;
+  struct Data {
+    char const *name;
+    int (*make)(int, std::mt19937 &);
+  };
+  const Data data[] = {
+      {"sorted ids", [](int i, std::mt19937 &gen) { return 4 * i + static_cast<int>(gen() % 4); }},
+      {"small ids", [](int, std::mt19937 &gen) { return static_cast<int>(gen() % 50000); }},
+      {"random", [](int, std::mt19937 &gen) { return static_cast<int>(gen()); }},
+  };
+
+  const int ops = 1000;
+  std::mt19937 gen(2024);
+  std::vector<size_t> positions;
+  for (int i = 0; i < ops; ++i) positions.push_back(gen() % static_cast<unsigned>(elements));
+
+  for (Data const &d: data) {
+    auto filled = [&d, elements](L &lar) {
+      std::mt19937 values(2024);
+      for (int i = 0; i < elements; ++i) lar.push_back(d.make(i, values));
+    };
+    std::function<void(L &)> fill = filled;
+    std::function<void(L &)> packed = [&filled](L &lar) {
+      filled(lar);
+      lar.compress_cold(4);
+    };
+
+    for (bool pack: {false, true}) {
+      std::string container = std::string("Lariat<int,4096> ") + d.name + (pack ? " packed" : "");
+      measure<L>(container, "operator[]", elements, ops, repetitions, pack ? packed : fill, [&](L &lar) {
+        for (size_t pos: positions) sink = sink + static_cast<size_t>(lar[pos]);
+      });
+      measure<L>(container, "reduce", elements, elements, repetitions, pack ? packed : fill, [](L &lar) {
+        sink = sink + static_cast<size_t>(lar.reduce(0LL, [](long long a, long long b) { return a + b; }));
+      });
+    }
+
+    L lar;
+    packed(lar);
+    LariatStats stats = lar.stats();
+    std::cerr << d.name << ": " << stats.packed_nodes << " of " << stats.nodes << " nodes packed, "
+              << stats.unpacked_bytes << " bytes of values in " << stats.packed_bytes << " bytes (ratio "
+              << static_cast<double>(stats.unpacked_bytes) / static_cast<double>(std::max<size_t>(stats.packed_bytes, 1))
+              << ")\n";
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// report
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void write_json(std::ostream &os, int repetitions) {
+  os << "{\n  \"repetitions\": " << repetitions << ",\n  \"unit\": \"ns_per_op\",\n  \"benchmarks\": [\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    Result const &r = results[i];
+    std::vector<double> sorted(r.ns_per_op);
+    std::sort(sorted.begin(), sorted.end());
+
+    double mean = 0;
+    for (double sample: sorted) mean += sample;
+    mean /= static_cast<double>(sorted.size());
+
+    double variance = 0;
+    for (double sample: sorted) variance += (sample - mean) * (sample - mean);
+    variance /= static_cast<double>(sorted.size());
+
+    os << "    {\"container\": \"" << r.container << "\", \"operation\": \"" << r.operation
+       << "\", \"elements\": " << r.elements << ", \"operations\": " << r.operations
+       << ", \"min\": " << sorted.front() << ", \"median\": " << sorted[sorted.size() / 2] << ", \"mean\": " << mean
+       << ", \"stddev\": " << std::sqrt(variance) << ", \"max\": " << sorted.back() << "}"
+       << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  os << "  ]\n}\n";
+}
+
+int main(int argc, char *argv[]) {
+  int repetitions = 5;
+  if (argc > 1) {
+    std::sscanf(argv[1], "%i", &repetitions);
+  }
+  if (repetitions < 1) {
+    repetitions = 1;
+  }
+
+  const int sizes[] = {1000, 10000, 100000};
+  try {
+    for (int elements: sizes) {
+      run_lariat<8>(elements, repetitions);
+      run_lariat<64>(elements, repetitions);
+      run_lariat<512>(elements, repetitions);
+      run_lariat<5000>(elements, repetitions);
+      run_all<std::vector<int>>("std::vector<int>", elements, repetitions);
+      run_all<std::deque<int>>("std::deque<int>", elements, repetitions);
+      run_all<std::list<int>>("std::list<int>", elements, repetitions);
+    }
+    run_parallel(1 << 22, repetitions);
+    run_sort(10000000, repetitions);
+    run_cursor(1000000, repetitions);
+    run_text(1 << 23, repetitions);
+    run_chunks(1 << 20, repetitions);
+    run_ingest(1 << 23, repetitions);
+    run_packed(1 << 20, repetitions);
+  } catch (const LariatException &le) {
+    std::cerr << le.what() << std::endl;
+    return 1;
+  }
+
+  if (argc > 2) {
+    std::ofstream out(argv[2]);
+    write_json(out, repetitions);
+  } else {
+    write_json(std::cout, repetitions);
+  }
+
+  return 0;
+}
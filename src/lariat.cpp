@@ -1,5 +1,21 @@
+#include <fcntl.h> // open, posix_fadvise
+#include <sys/mman.h> // mmap, msync, madvise
+#include <unistd.h> // ftruncate, unlink, close
+
+#include <algorithm> // upper_bound
+#include <cerrno> // EINTR
+#include <charconv> // to_chars, from_chars
+#include <cstdint>
+#include <exception> // exception_ptr
+#include <functional> // less
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <locale>
+#include <new> // placement new
 #include <ostream>
+#include <thread>
+#include <type_traits>
 #include <utility>
 
 #define LARIAT_CPP
@@ -11,7 +27,8 @@
 // Utility Implementation
 
 /**
- * @brief A replacement of the std::swap function
+ * @brief A replacement of the std::swap function, called as ::swap so that argument dependent lookup does not
+ * also find std::swap for elements from namespace std such as std::string_view
  *
  * @param a The value to swap with b
  * @param b The value to swap with a
@@ -23,24 +40,471 @@ void swap(T &a, T &b) {
   b = std::move(temp);
 }
 
+/**
+ * @brief Converts a run of elements, in blocks of 8 so that the compiler can vectorize the conversion
+ *
+ * @param destination Where the converted elements go
+ * @param source The elements to convert
+ * @param count Number of elements
+ */
+template<typename To, typename From>
+void lariat_convert(To *__restrict destination, const From *__restrict source, int count) {
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    for (int j = 0; j < 8; j++) {
+      destination[i + j] = static_cast<To>(source[i + j]);
+    }
+  }
+  for (; i < count; i++) {
+    destination[i] = static_cast<To>(source[i]);
+  }
+}
+
+/**
+ * @brief Packs integers with frame of reference or delta encoding, whichever needs fewer bits per value. The first
+ * word holds the encoding and the bit width, then come the base and the smallest delta, then the packed values.
+ *
+ * @param values The integers, sign extended when is_signed
+ * @param count Number of integers, at least 1
+ * @param is_signed Whether the integers are compared as signed
+ * @param packed Where the packed words are written
+ */
+inline void lariat_pack(const std::uint64_t *values, int count, bool is_signed, std::vector<std::uint64_t> &packed) {
+  auto less = [is_signed](std::uint64_t a, std::uint64_t b) {
+    return is_signed ? static_cast<std::int64_t>(a) < static_cast<std::int64_t>(b) : a < b;
+  };
+  auto width_of = [](std::uint64_t range) {
+    int width = 0;
+    while (width < 64 && (range >> width) != 0) {
+      width++;
+    }
+    return width;
+  };
+
+  std::uint64_t low = values[0], high = values[0];
+  std::int64_t low_delta = 0, high_delta = 0;
+  for (int i = 1; i < count; i++) {
+    low = less(values[i], low) ? values[i] : low;
+    high = less(high, values[i]) ? values[i] : high;
+
+    std::int64_t delta = static_cast<std::int64_t>(values[i] - values[i - 1]);
+    low_delta = i == 1 || delta < low_delta ? delta : low_delta;
+    high_delta = i == 1 || delta > high_delta ? delta : high_delta;
+  }
+
+  // NOTE: Deltas store count - 1 values after the first one, the base
+  int range_width = width_of(high - low);
+  int delta_width = width_of(static_cast<std::uint64_t>(high_delta) - static_cast<std::uint64_t>(low_delta));
+  bool deltas = delta_width < range_width;
+  int width = deltas ? delta_width : range_width;
+
+  packed.assign(3 + (static_cast<std::size_t>(count) * static_cast<std::size_t>(width) + 63) / 64, 0);
+  packed[0] = static_cast<std::uint64_t>(deltas) | static_cast<std::uint64_t>(width) << 1;
+  packed[1] = deltas ? values[0] : low;
+  packed[2] = static_cast<std::uint64_t>(low_delta);
+
+  std::size_t bit = 0;
+  for (int i = deltas ? 1 : 0; i < count && width > 0; i++) {
+    std::uint64_t value = deltas ? values[i] - values[i - 1] - packed[2] : values[i] - low;
+    std::size_t word = 3 + bit / 64, offset = bit % 64;
+    packed[word] |= value << offset;
+    if (offset + static_cast<std::size_t>(width) > 64) {
+      packed[word + 1] |= value >> (64 - offset);
+    }
+    bit += static_cast<std::size_t>(width);
+  }
+}
+
+/**
+ * @brief Restores the integers packed by lariat_pack.
+ *
+ * @param packed The packed words
+ * @param count Number of integers
+ * @param values Where the integers are written
+ */
+inline void lariat_unpack(const std::vector<std::uint64_t> &packed, int count, std::uint64_t *values) {
+  bool deltas = (packed[0] & 1) != 0;
+  std::size_t width = static_cast<std::size_t>(packed[0] >> 1);
+  std::uint64_t mask = width == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << width) - 1;
+
+  values[0] = packed[1];
+  std::size_t bit = 0;
+  for (int i = deltas ? 1 : 0; i < count; i++) {
+    std::uint64_t value = 0;
+    if (width > 0) {
+      std::size_t word = 3 + bit / 64, offset = bit % 64;
+      value = packed[word] >> offset;
+      if (offset + width > 64) {
+        value |= packed[word + 1] << (64 - offset);
+      }
+      value &= mask;
+      bit += width;
+    }
+    values[i] = deltas ? values[i - 1] + packed[2] + value : packed[1] + value;
+  }
+}
+
+// Spill File Implementation
+
+/**
+ * @brief Creates the backing file and reserves the address space for the slots.
+ *
+ * @param path Location of the backing file (removed from the file system once opened)
+ * @param slot_size Size in bytes of every slot
+ * @param resident_limit Amount of bytes that are allowed to stay in memory
+ */
+inline LariatSpillFile::LariatSpillFile(const char *path, std::size_t slot_size, std::size_t resident_limit) :
+    fd_(-1),
+    base_(nullptr),
+    slot_size_(slot_size),
+    file_bytes_(0),
+    used_slots_(0),
+    extent_limit_(resident_limit / extent_bytes),
+    last_extent_(reserve_bytes) {
+  // NOTE: A slot can straddle two extents, both of them have to fit
+  if (extent_limit_ < 2) {
+    extent_limit_ = 2;
+  }
+
+  fd_ = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+  if (fd_ == -1) {
+    throw LariatException(LariatException::E_DATA_ERROR, std::string("Unable to create backing file ") + path);
+  }
+  ::unlink(path);
+
+  void *mapping = ::mmap(nullptr, reserve_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (mapping == MAP_FAILED) {
+    ::close(fd_);
+    throw LariatException(LariatException::E_NO_MEMORY, "Unable to map the backing file");
+  }
+  base_ = static_cast<char *>(mapping);
+}
+
+inline LariatSpillFile::~LariatSpillFile() {
+  ::munmap(base_, reserve_bytes);
+  ::close(fd_);
+}
+
+/**
+ * @brief Retrieves an unused slot, growing the backing file if needed. This will throw an exception if it fails.
+ */
+inline void *LariatSpillFile::allocate() {
+  if (!free_slots_.empty()) {
+    void *slot = free_slots_.back();
+    free_slots_.pop_back();
+    return slot;
+  }
+
+  std::size_t end = (used_slots_ + 1) * slot_size_;
+  if (end > reserve_bytes) {
+    throw LariatException(LariatException::E_NO_MEMORY, "Backing file is out of reserved address space");
+  }
+
+  if (end > file_bytes_) {
+    std::size_t new_bytes = (end + growth_bytes - 1) / growth_bytes * growth_bytes;
+    if (::ftruncate(fd_, static_cast<off_t>(new_bytes)) != 0) {
+      throw LariatException(LariatException::E_NO_MEMORY, "Unable to grow the backing file");
+    }
+    file_bytes_ = new_bytes;
+  }
+
+  return base_ + used_slots_++ * slot_size_;
+}
+
+/**
+ * @brief Returns a slot so it can be reused by allocate().
+ */
+inline void LariatSpillFile::release(void *slot) {
+  free_slots_.push_back(slot);
+}
+
+/**
+ * @brief Marks the extents covering the slot as most recently used, evicting the coldest ones if over the limit.
+ */
+inline void LariatSpillFile::touch(const void *slot) {
+  std::size_t offset = static_cast<std::size_t>(static_cast<const char *>(slot) - base_);
+
+  touch_extent(offset / extent_bytes);
+  touch_extent((offset + slot_size_ - 1) / extent_bytes);
+}
+
+/**
+ * @brief Amount of bytes of the extents currently tracked as resident.
+ */
+inline std::size_t LariatSpillFile::resident_bytes() const {
+  return resident_.size() * extent_bytes;
+}
+
+inline void LariatSpillFile::touch_extent(std::size_t extent) {
+  // NOTE: Repeated accesses to the same extent (push_back, pop_front) skip the LRU bookkeeping
+  if (extent == last_extent_) {
+    return;
+  }
+  last_extent_ = extent;
+
+  auto found = resident_.find(extent);
+  if (found != resident_.end()) {
+    lru_.splice(lru_.begin(), lru_, found->second);
+    return;
+  }
+
+  lru_.push_front(extent);
+  resident_.emplace(extent, lru_.begin());
+
+  if (resident_.size() > extent_limit_) {
+    std::size_t coldest = lru_.back();
+    lru_.pop_back();
+    resident_.erase(coldest);
+    evict(coldest);
+  }
+}
+
+inline void LariatSpillFile::evict(std::size_t extent) {
+  std::size_t offset = extent * extent_bytes;
+  if (offset >= file_bytes_) {
+    return;
+  }
+
+  std::size_t length = file_bytes_ - offset < extent_bytes ? file_bytes_ - offset : extent_bytes;
+
+  // NOTE: Writing the pages back before dropping them from the mapping and from the page cache
+  ::msync(base_ + offset, length, MS_SYNC);
+  ::madvise(base_ + offset, length, MADV_DONTNEED);
+  ::posix_fadvise(fd_, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_DONTNEED);
+}
+
+// Stats Implementation
+
+inline std::ostream &operator<<(std::ostream &os, LariatStats const &stats) {
+  os << "Allocations " << stats.allocations << ", frees " << stats.frees << ", splits " << stats.splits
+     << ", merges " << stats.merges << "\n";
+  os << "Lookups " << stats.lookups << ", nodes traversed " << stats.nodes_traversed;
+  if (stats.lookups > 0) {
+    os << " (" << static_cast<double>(stats.nodes_traversed) / static_cast<double>(stats.lookups) << " per lookup)";
+  }
+  os << ", elements shifted " << stats.elements_shifted << "\n";
+  os << "Nodes " << stats.nodes << " (peak " << stats.peak_nodes << ") of " << stats.node_bytes << " bytes\n";
+  if (stats.packs > 0 || stats.packed_nodes > 0) {
+    os << "Packed nodes " << stats.packed_nodes << ", " << stats.packed_bytes << " bytes for " << stats.unpacked_bytes
+       << " bytes of values, packs " << stats.packs << ", unpacks " << stats.unpacks << "\n";
+  }
+
+  os << "Occupancy\n";
+  for (int i = 0; i < LariatStats::buckets; i++) {
+    int from = i * 100 / LariatStats::buckets;
+    int to = (i + 1) * 100 / LariatStats::buckets;
+    os << std::setw(3) << from << "% - " << std::setw(3) << to << (i + 1 == LariatStats::buckets ? "%]" : "%)")
+       << " " << stats.occupancy[i] << "\n";
+  }
+  return os;
+}
+
+// Output Buffer Implementation
+
+inline LariatOutputBuffer::LariatOutputBuffer(std::ostream &os) : os_(os), fast_(false), used_(0) {
+  std::ios_base::fmtflags flags = os.flags();
+  std::ios_base::fmtflags unsupported =
+      std::ios_base::showpos | std::ios_base::showpoint | std::ios_base::showbase | std::ios_base::uppercase;
+
+  fast_ = (flags & std::ios_base::basefield) == std::ios_base::dec && (flags & std::ios_base::floatfield) == 0 &&
+          (flags & unsupported) == 0 && os.getloc() == std::locale::classic();
+}
+
+inline LariatOutputBuffer::~LariatOutputBuffer() {
+  flush();
+}
+
+inline void LariatOutputBuffer::put(char c) {
+  if (used_ == capacity) {
+    flush();
+  }
+  buffer_[used_++] = c;
+}
+
+inline void LariatOutputBuffer::put(const char *text) {
+  for (; *text != '\0'; ++text) {
+    put(*text);
+  }
+}
+
+inline void LariatOutputBuffer::put(char c, int repeat) {
+  for (int i = 0; i < repeat; i++) {
+    put(c);
+  }
+}
+
+/**
+ * @brief Formats a value, right aligned if width is larger than the formatted text.
+ */
+template<typename V>
+void LariatOutputBuffer::put_value(const V &value, int width) {
+  // NOTE: Character types are printed as characters by the stream, they never take the fast path
+  constexpr bool is_number =
+      std::is_floating_point<V>::value ||
+      (std::is_integral<V>::value && sizeof(V) > 1 && !std::is_same<V, wchar_t>::value &&
+       !std::is_same<V, char16_t>::value && !std::is_same<V, char32_t>::value);
+
+  if constexpr (is_number) {
+    if (fast_) {
+      char text[max_number];
+      std::to_chars_result result;
+      if constexpr (std::is_floating_point<V>::value) {
+        result = std::to_chars(
+            text, text + max_number, value, std::chars_format::general, static_cast<int>(os_.precision()));
+      } else {
+        result = std::to_chars(text, text + max_number, value);
+      }
+
+      if (result.ec == std::errc()) {
+        put_padded(text, static_cast<std::size_t>(result.ptr - text), width);
+        return;
+      }
+    }
+  }
+
+  flush();
+  os_ << std::setw(width) << value;
+}
+
+/**
+ * @brief Formats an address the same way the stream does ("0" for nullptr).
+ */
+inline void LariatOutputBuffer::put_address(const void *address, int width) {
+  if (!fast_) {
+    flush();
+    os_ << std::setw(width) << address;
+    return;
+  }
+
+  if (address == nullptr) {
+    put_padded("0", 1, width);
+    return;
+  }
+
+  char text[max_number] = {'0', 'x'};
+  std::to_chars_result result =
+      std::to_chars(text + 2, text + max_number, reinterpret_cast<std::uintptr_t>(address), 16);
+  put_padded(text, static_cast<std::size_t>(result.ptr - text), width);
+}
+
+/**
+ * @brief Hands the collected text to the stream.
+ */
+inline void LariatOutputBuffer::flush() {
+  if (used_ > 0) {
+    os_.write(buffer_, static_cast<std::streamsize>(used_));
+    used_ = 0;
+  }
+}
+
+inline void LariatOutputBuffer::put_padded(const char *text, std::size_t length, int width) {
+  if (width > 0 && static_cast<std::size_t>(width) > length) {
+    put(' ', width - static_cast<int>(length));
+  }
+
+  if (capacity - used_ < length) {
+    flush();
+  }
+  std::memcpy(buffer_ + used_, text, length);
+  used_ += length;
+}
+
+// Parallel Implementation
+
+/**
+ * @brief Sets the number of threads to use, 0 for one per hardware thread (the default)
+ */
+inline void LariatParallel::threads(unsigned count) {
+  setting() = count;
+}
+
+/**
+ * @brief Number of threads to use
+ */
+inline unsigned LariatParallel::threads() {
+  unsigned count = setting() != 0 ? setting() : std::thread::hardware_concurrency();
+  return count != 0 ? count : 1;
+}
+
+/**
+ * @brief Number of parts to split n elements into, 1 when n is too small to be worth threads
+ */
+inline std::size_t LariatParallel::parts(std::size_t n) {
+  std::size_t by_size = n / min_elements;
+  std::size_t count = threads();
+  return by_size < 1 ? 1 : by_size < count ? by_size : count;
+}
+
+/**
+ * @brief Calls work(part) for every part in [0, parts), each part on its own thread. The first exception thrown by
+ * work is rethrown once every part is done.
+ */
+template<typename F>
+void LariatParallel::run(std::size_t parts, const F &work) {
+  if (parts <= 1) {
+    if (parts == 1) {
+      work(std::size_t{0});
+    }
+    return;
+  }
+
+  std::vector<std::exception_ptr> errors(parts);
+  std::vector<std::thread> workers;
+  workers.reserve(parts - 1);
+
+  // NOTE: The calling thread takes part 0
+  for (std::size_t part = 1; part < parts; part++) {
+    workers.emplace_back([&work, &errors, part]() {
+      try {
+        work(part);
+      } catch (...) {
+        errors[part] = std::current_exception();
+      }
+    });
+  }
+
+  try {
+    work(std::size_t{0});
+  } catch (...) {
+    errors[0] = std::current_exception();
+  }
+
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+
+  for (const std::exception_ptr &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+inline unsigned &LariatParallel::setting() {
+  static unsigned count = 0;
+  return count;
+}
+
 // Constructors + Destructor
 
 /**
  * @brief Constructs an empty Lariat
  */
 template<typename T, int Size>
-Lariat<T, Size>::Lariat() : head_(nullptr), tail_(nullptr), size_(0), nodecount_(0), asize_(0) {}
+Lariat<T, Size>::Lariat() :
+    head_(nullptr), tail_(nullptr), size_(0), nodecount_(0), asize_(Size), spill_(nullptr), split_(LariatSplit::Even),
+    inline_used_(false), spare_(nullptr), spare_count_(0), compact_from_(nullptr), compact_ratio_(0), compact_budget_(0),
+    cold_(nullptr), lines_(nullptr) {}
 
 /**
  * @brief Copy contructor for Lariat
  */
 template<typename T, int Size>
-Lariat<T, Size>::Lariat(const Lariat &other) : head_(nullptr), tail_(nullptr), size_(0), nodecount_(0) {
-  clear();
-
-  for (int i = 0; i < other.size_; i++) {
-    push_back(other[i]);
-  }
+Lariat<T, Size>::Lariat(const Lariat &other) :
+    head_(nullptr), tail_(nullptr), size_(0), nodecount_(0), asize_(Size), spill_(nullptr), split_(other.split_),
+    inline_used_(false), spare_(nullptr), spare_count_(0), compact_from_(nullptr), compact_ratio_(other.compact_ratio_),
+    compact_budget_(other.compact_budget_), cold_(nullptr), lines_(nullptr) {
+  copy_from(other);
 }
 
 /**
@@ -49,44 +513,53 @@ Lariat<T, Size>::Lariat(const Lariat &other) : head_(nullptr), tail_(nullptr), s
 template<typename T, int Size>
 template<typename OtherT, int OtherSize>
 Lariat<T, Size>::Lariat(const Lariat<OtherT, OtherSize> &other) :
-    head_(nullptr), tail_(nullptr), size_(0), nodecount_(0) {
-  clear();
-
-  for (int i = 0; i < other.size_; i++) {
-    push_back(static_cast<T>(other[i]));
-  }
+    head_(nullptr), tail_(nullptr), size_(0), nodecount_(0), asize_(Size), spill_(nullptr), split_(other.split_),
+    inline_used_(false), spare_(nullptr), spare_count_(0), compact_from_(nullptr), compact_ratio_(other.compact_ratio_),
+    compact_budget_(other.compact_budget_), cold_(nullptr), lines_(nullptr) {
+  copy_from(other);
 }
 
 /**
- * @brief Copy assignment operator for Lariat
+ * @brief Copy assignment operator for Lariat, the split policy and the automatic compaction are copied along
+ * with the elements like the copy constructor does
  */
 template<typename T, int Size>
 Lariat<T, Size> &Lariat<T, Size>::operator=(const Lariat &other) {
-  clear();
-
-  for (int i = 0; i < other.size_; i++) {
-    push_back(other[i]);
+  if (this == &other) {
+    return *this;
   }
+
+  // NOTE: The settings are copied first, copy_from gives the nodes the counts the split policy would give them
+  clear();
+  split_ = other.split_;
+  compact_ratio_ = other.compact_ratio_;
+  compact_budget_ = other.compact_budget_;
+  copy_from(other);
   return *this;
 }
 
 /**
- * @brief Templatized copy assignment operator for Lariat
+ * @brief Templatized copy assignment operator for Lariat, the split policy and the automatic compaction are copied along
+ * with the elements like the copy constructor does
  */
 template<typename T, int Size>
 template<typename OtherT, int OtherSize>
 Lariat<T, Size> &Lariat<T, Size>::operator=(const Lariat<OtherT, OtherSize> &other) {
   clear();
-
-  for (int i = 0; i < other.size_; i++) {
-    push_back(static_cast<T>(other[i]));
-  }
+  split_ = other.split_;
+  compact_ratio_ = other.compact_ratio_;
+  compact_budget_ = other.compact_budget_;
+  copy_from(other);
   return *this;
 }
 
 template<typename T, int Size>
 Lariat<T, Size>::~Lariat() {
   clear();
+  release_spares();
+  delete spill_;
+  delete cold_;
+  delete lines_;
 }
 
 // Insertion Methods
@@ -98,11 +571,22 @@ Lariat<T, Size>::~Lariat() {
  * @param value Value to insert
  */
 template<typename T, int Size>
-void Lariat<T, Size>::insert(int index, const T &value) {
-  if (index < 0 || index > size_) {
+void Lariat<T, Size>::insert(size_type index, const T &value) {
+  if (index > size_) {
     throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
   }
 
+  insert_unchecked(index, value);
+}
+
+/**
+ * @brief Insert a value of type T into the Lariat without checking the index, which must be in [0, size()]
+ *
+ * @param index Location to insert
+ * @param value Value to insert
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::insert_unchecked(size_type index, const T &value) {
   if (index == 0) {
     push_front(value);
     return;
@@ -113,26 +597,36 @@ void Lariat<T, Size>::insert(int index, const T &value) {
     return;
   }
 
-  ElementSearch search = find_element(index);
+  insert_at(find_element(index), value);
+  auto_compact_step();
+}
 
+/**
+ * @brief Inserts a value at a position found by find_element, before the element at that position.
+ *
+ * @param search The position to insert at
+ * @param value Value to insert
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::insert_at(ElementSearch search, const T &value) {
   LNode *node = search.node;
 
   shift_up(node, search.index);
 
   if (node->count < Size) {
-    node->values[search.index] = value;
+    node->value(search.index) = value;
     ++node->count;
 
   } else {
-    T overflow = node->values[search.index];
-    node->values[search.index] = value;
+    T overflow = node->value(search.index);
+    node->value(search.index) = value;
 
     LNode *new_half = split(*node);
     if (node == tail_) {
       tail_ = new_half;
     }
 
-    new_half->values[new_half->count] = overflow;
+    new_half->value(new_half->count) = overflow;
     ++new_half->count;
   }
 
@@ -148,7 +642,7 @@ template<typename T, int Size>
 void Lariat<T, Size>::push_front(const T &value) {
   if (head_ == nullptr) {
     head_ = create_node();
-    head_->values[0] = value;
+    head_->value(0) = value;
     ++head_->count;
 
     tail_ = head_;
@@ -158,18 +652,29 @@ void Lariat<T, Size>::push_front(const T &value) {
   }
 
   LNode *node = head_;
+  touch(node);
+
+  if (node->count == Size && split_ == LariatSplit::Append) {
+    head_ = link_node(node, false);
+    head_->value(0) = value;
+    ++head_->count;
+    size_++;
+    auto_compact_step();
+    return;
+  }
+
   shift_up(node, 0);
 
   if (node->count < Size) {
-    node->values[0] = value;
+    node->value(0) = value;
     node->count++;
 
   } else {
-    T overflow = node->values[0];
-    node->values[0] = value;
+    T overflow = node->value(0);
+    node->value(0) = value;
 
     LNode *new_half = split(*node);
-    new_half->values[new_half->count] = overflow;
+    new_half->value(new_half->count) = overflow;
     new_half->count++;
 
     if (head_ == tail_) {
@@ -178,6 +683,7 @@ void Lariat<T, Size>::push_front(const T &value) {
   }
 
   size_++;
+  auto_compact_step();
 }
 
 /**
@@ -189,7 +695,7 @@ template<typename T, int Size>
 void Lariat<T, Size>::push_back(const T &value) {
   if (tail_ == nullptr) {
     head_ = create_node();
-    head_->values[0] = value;
+    head_->value(0) = value;
     head_->count++;
 
     tail_ = head_;
@@ -198,14 +704,16 @@ void Lariat<T, Size>::push_back(const T &value) {
     return;
   }
 
+  touch(tail_);
   if (tail_->count == Size) {
-    tail_ = split(*tail_);
+    tail_ = split_ == LariatSplit::Append ? link_node(tail_, true) : split(*tail_);
   }
 
-  tail_->values[tail_->count] = value;
+  tail_->value(tail_->count) = value;
   tail_->count++;
 
   size_++;
+  auto_compact_step();
 }
 
 // Deletion Methods
@@ -216,27 +724,44 @@ void Lariat<T, Size>::push_back(const T &value) {
  * @param index Index of value to delete
  */
 template<typename T, int Size>
-void Lariat<T, Size>::erase(int index) {
+void Lariat<T, Size>::erase(size_type index) {
   if (size_ == 0) {
     throw LariatException(LariatException::E_DATA_ERROR, "Cannot delete in an empty Lariat");
   }
 
-  if (index < 0 || index >= size_) {
+  if (index >= size_) {
     throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
   }
 
-  if (index == 0) {
-    pop_front();
-    return;
-  }
+  erase_unchecked(index);
+}
 
-  if (index == size_ - 1) {
-    pop_back();
-    return;
+/**
+ * @brief Erase the value at index without checking the index, which must be in [0, size())
+ *
+ * @param index Index of value to delete
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::erase_unchecked(size_type index) {
+  if (index == 0) {
+    remove_front();
+  } else if (index == size_ - 1) {
+    remove_back();
+  } else {
+    erase_at(find_element(index));
   }
 
-  ElementSearch search = find_element(index);
+  auto_compact_step();
+}
 
+/**
+ * @brief Erases the element at a position found by find_element, the node must not be the head or the tail when it
+ * becomes empty.
+ *
+ * @param search The position of the element to erase
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::erase_at(ElementSearch search) {
   shift_down(search.node, search.index);
   search.node->count--;
   size_--;
@@ -245,39 +770,90 @@ void Lariat<T, Size>::erase(int index) {
     search.node->prev->next = search.node->next;
     search.node->next->prev = search.node->prev;
 
-    delete search.node;
+    destroy_node(search.node);
     nodecount_--;
   }
 }
 
 /**
- * @brief Erase the first element in the Lariat
+ * @brief Erase count values starting at index. Nodes that are erased completely are released, the others move the
+ * shorter side of their remaining elements once.
+ *
+ * @param index Index of the first value to delete
+ * @param count Number of values to delete, index + count must not be past size()
  */
 template<typename T, int Size>
-void Lariat<T, Size>::pop_front() {
-  if (size_ == 0) {
-    throw LariatException(LariatException::E_DATA_ERROR, "Cannot delete in an empty Lariat");
+void Lariat<T, Size>::erase(size_type index, size_type count) {
+  if (index > size_ || count > size_ - index) {
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
   }
 
-  shift_down(head_, 0);
-  --head_->count;
-  size_--;
-
-  if (head_->count == 0) {
-    LNode *new_head = head_->next;
+  if (count == 0) {
+    return;
+  }
 
-    delete head_;
-    nodecount_--;
+  BatchCursor from;
+  ElementSearch search = seek(from, index);
+  LNode *node = search.node;
+  int offset = search.index;
+
+  while (count > 0) {
+    touch(node);
+    LNode *next = node->next;
+    int erased = count < static_cast<size_type>(node->count - offset) ? static_cast<int>(count) : node->count - offset;
+
+    if (erased == node->count) {
+      if (node->prev != nullptr) {
+        node->prev->next = next;
+      } else {
+        head_ = next;
+      }
+      if (next != nullptr) {
+        next->prev = node->prev;
+      } else {
+        tail_ = node->prev;
+      }
 
-    if (tail_ == head_) {
-      tail_ = new_head;
+      destroy_node(node);
+      nodecount_--;
+    } else {
+      // NOTE: The elements before the gap move up when they are fewer than the ones after it
+      int after = node->count - offset - erased;
+      if (offset < after) {
+        LARIAT_COUNT(elements_shifted, offset);
+        for (int i = offset - 1; i >= 0; i--) {
+          node->value(i + erased) = node->value(i);
+        }
+        node->start = node->start + erased < Size ? node->start + erased : node->start + erased - Size;
+      } else {
+        LARIAT_COUNT(elements_shifted, after);
+        for (int i = offset; i < offset + after; i++) {
+          node->value(i) = node->value(i + erased);
+        }
+      }
+      node->count -= erased;
     }
-    head_ = new_head;
 
-    if (head_ != nullptr) {
-      head_->prev = nullptr;
-    }
+    size_ -= static_cast<size_type>(erased);
+    count -= static_cast<size_type>(erased);
+    node = next;
+    offset = 0;
+  }
+
+  auto_compact_step();
+}
+
+/**
+ * @brief Erase the first element in the Lariat
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::pop_front() {
+  if (size_ == 0) {
+    throw LariatException(LariatException::E_DATA_ERROR, "Cannot delete in an empty Lariat");
   }
+
+  remove_front();
+  auto_compact_step();
 }
 
 /**
@@ -289,13 +865,150 @@ void Lariat<T, Size>::pop_back() {
     throw LariatException(LariatException::E_DATA_ERROR, "Cannot delete in an empty Lariat");
   }
 
-  --tail_->count;
+  remove_back();
+  auto_compact_step();
+}
+
+/**
+ * @brief Erase every element for which pred is true, in one pass that packs the remaining elements into full nodes
+ * and releases the nodes left empty. pred must not throw.
+ *
+ * @param pred Function taking a const T&
+ * @return Number of erased elements
+ */
+template<typename T, int Size>
+template<typename Predicate>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::erase_if(Predicate pred) {
+  return remove_matching([&pred](const T &value, const T *) { return static_cast<bool>(pred(value)); });
+}
+
+/**
+ * @brief Erase every element equal to value, see erase_if.
+ *
+ * @param value The value to erase
+ * @return Number of erased elements
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::remove(const T &value) {
+  // NOTE: value may be an element of the Lariat that gets overwritten
+  const T to_remove = value;
+  return remove_matching([&to_remove](const T &element, const T *) { return element == to_remove; });
+}
+
+/**
+ * @brief Erase every element equal to the element before it, see erase_if.
+ *
+ * @return Number of erased elements
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::unique() {
+  return remove_matching([](const T &element, const T *kept) { return kept != nullptr && *kept == element; });
+}
+
+/**
+ * @brief Moves the elements to keep towards the front with a write position that trails the read position, then
+ * releases the nodes after the last written one.
+ *
+ * @param remove Function taking the element and the last kept element (nullptr before the first one)
+ * @return Number of erased elements
+ */
+template<typename T, int Size>
+template<typename Remove>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::remove_matching(Remove remove) {
+  if (size_ == 0) {
+    return 0;
+  }
+
+  // NOTE: Every node holds at most Size elements, so the write position never passes the read position even when it
+  // fills a node past the count it had
+  LNode *write = head_;
+  int written = 0;
+  const T *kept = nullptr;
+  size_type removed = 0;
+  for (LNode *read = head_; read != nullptr; read = read->next) {
+    touch(read);
+    touch(write);
+    const int count = read->count;
+    for (int i = 0; i < count; i++) {
+      T &value = read->value(i);
+      if (remove(static_cast<const T &>(value), kept)) {
+        removed++;
+        continue;
+      }
+
+      if (written == Size) {
+        write->count = Size;
+        write = write->next;
+        written = 0;
+        touch(write);
+        touch(read);
+      }
+      if (write != read || written != i) {
+        write->value(written) = std::move(value);
+      }
+      kept = &write->value(written);
+      written++;
+    }
+  }
+
+  if (removed == size_) {
+    clear();
+    return removed;
+  }
+
+  size_ -= removed;
+  write->count = written;
+  for (LNode *node = write->next; node != nullptr;) {
+    LNode *next = node->next;
+    destroy_node(node);
+    nodecount_--;
+    node = next;
+  }
+  write->next = nullptr;
+  tail_ = write;
+  return removed;
+}
+
+/**
+ * @brief Erase the first element of a non-empty Lariat
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::remove_front() {
+  touch(head_);
+  shift_down(head_, 0);
+  --head_->count;
+  size_--;
+
+  if (head_->count == 0) {
+    LNode *new_head = head_->next;
+
+    destroy_node(head_);
+    nodecount_--;
+
+    if (tail_ == head_) {
+      tail_ = new_head;
+    }
+    head_ = new_head;
+
+    if (head_ != nullptr) {
+      head_->prev = nullptr;
+    }
+  }
+}
+
+/**
+ * @brief Erase the last element of a non-empty Lariat
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::remove_back() {
+  touch(tail_);
+  --tail_->count;
   size_--;
 
   if (tail_->count == 0) {
     LNode *new_tail = tail_->prev;
 
-    delete tail_;
+    destroy_node(tail_);
     nodecount_--;
 
     if (tail_ == head_) {
@@ -312,29 +1025,59 @@ void Lariat<T, Size>::pop_back() {
 // Access Methods
 
 /**
- * @brief Retrieves the element at index
+ * @brief Retrieves the element at index, the index is not checked and must be in [0, size())
  *
  * @param index The index of the element to retrieve
  * @return Reference to retrieved value
  */
 template<typename T, int Size>
-T &Lariat<T, Size>::operator[](int index) {
+T &Lariat<T, Size>::operator[](size_type index) {
   ElementSearch search = find_element(index);
 
-  return search.node->values[search.index];
+  return search.node->value(search.index);
 }
 
 /**
- * @brief Retrieves the element at index with a const reference
+ * @brief Retrieves the element at index with a const reference, the index is not checked and must be in [0, size())
  *
  * @param index The index of the element to retrieve
  * @return Const reference to retrieved value
  */
 template<typename T, int Size>
-const T &Lariat<T, Size>::operator[](int index) const {
+const T &Lariat<T, Size>::operator[](size_type index) const {
   ElementSearch search = find_element(index);
 
-  return search.node->values[search.index];
+  return search.node->value(search.index);
+}
+
+/**
+ * @brief Retrieves the element at index, throws E_BAD_INDEX if the index is out of range
+ *
+ * @param index The index of the element to retrieve
+ * @return Reference to retrieved value
+ */
+template<typename T, int Size>
+T &Lariat<T, Size>::at(size_type index) {
+  if (index >= size_) {
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+  }
+
+  return (*this)[index];
+}
+
+/**
+ * @brief Retrieves the element at index with a const reference, throws E_BAD_INDEX if the index is out of range
+ *
+ * @param index The index of the element to retrieve
+ * @return Const reference to retrieved value
+ */
+template<typename T, int Size>
+const T &Lariat<T, Size>::at(size_type index) const {
+  if (index >= size_) {
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+  }
+
+  return (*this)[index];
 }
 
 /**
@@ -348,7 +1091,8 @@ T &Lariat<T, Size>::first() {
     throw LariatException(LariatException::E_BAD_INDEX, "Empty lariat, cannot access first element");
   }
 
-  return head_->values[0];
+  touch(head_);
+  return head_->value(0);
 }
 
 /**
@@ -362,7 +1106,8 @@ T const &Lariat<T, Size>::first() const {
     throw LariatException(LariatException::E_BAD_INDEX, "Empty lariat, cannot access first element");
   }
 
-  return head_->values[0];
+  touch(head_);
+  return head_->value(0);
 }
 
 /**
@@ -376,7 +1121,8 @@ T &Lariat<T, Size>::last() {
     throw LariatException(LariatException::E_BAD_INDEX, "Empty lariat, cannot access last element");
   }
 
-  return tail_->values[tail_->count - 1];
+  touch(tail_);
+  return tail_->value(tail_->count - 1);
 }
 
 /**
@@ -390,7 +1136,8 @@ T const &Lariat<T, Size>::last() const {
     throw LariatException(LariatException::E_BAD_INDEX, "Empty lariat, cannot access last element");
   }
 
-  return tail_->values[tail_->count - 1];
+  touch(tail_);
+  return tail_->value(tail_->count - 1);
 }
 
 /**
@@ -400,222 +1147,2374 @@ T const &Lariat<T, Size>::last() const {
  * @return index of the element
  */
 template<typename T, int Size>
-unsigned Lariat<T, Size>::find(const T &value) const {
+typename Lariat<T, Size>::size_type Lariat<T, Size>::find(const T &value) const {
 
-  unsigned stepped_indexes = 0;
+  size_type stepped_indexes = 0;
   for (LNode *current = head_; current != nullptr; current = current->next) {
+    touch(current);
 
     for (int i = 0; i < current->count; i++) {
-      if (current->values[i] == value) {
-        return stepped_indexes + static_cast<unsigned>(i);
+      if (current->value(i) == value) {
+        return stepped_indexes + static_cast<size_type>(i);
       }
     }
 
-    stepped_indexes += current->count;
+    stepped_indexes += static_cast<size_type>(current->count);
   }
 
-  return static_cast<unsigned>(size_);
+  return size_;
 }
 
-// Miscelaneous Methods
-
 /**
- * @brief Retrieve the element where value T is
+ * @brief Calls fn with every contiguous piece of the elements in [begin, end), in order: at most two pieces per node,
+ * pointing into the node itself. The pointers are only valid during the call, fn must not change the Lariat.
  *
- * @return The amount of elements contained in the data structure
+ * @param begin Index of the first element
+ * @param end Index after the last element, throws E_BAD_INDEX if begin > end or end > size()
+ * @param fn Function taking a const T* and a std::size_t number of elements
  */
 template<typename T, int Size>
-size_t Lariat<T, Size>::size() const {
-  return size_;
+template<typename F>
+void Lariat<T, Size>::for_each_chunk(size_type begin, size_type end, F fn) const {
+  if (begin > end || end > size_) {
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+  }
+
+  if (begin == end) {
+    return;
+  }
+
+  BatchCursor from;
+  ElementSearch search = seek(from, begin);
+  const LNode *node = search.node;
+  int offset = search.index;
+  for (size_type remaining = end - begin; remaining > 0; node = node->next, offset = 0) {
+    touch(node);
+
+    // NOTE: The elements are in at most two contiguous pieces, from start up to the end of the ring and from the
+    // beginning of the ring
+    int count = remaining < static_cast<size_type>(node->count - offset) ? static_cast<int>(remaining)
+                                                                         : node->count - offset;
+    int first = node->start + offset < Size ? node->start + offset : node->start + offset - Size;
+    int piece = count < Size - first ? count : Size - first;
+    fn(node->values + first, static_cast<std::size_t>(piece));
+    if (piece < count) {
+      fn(node->values, static_cast<std::size_t>(count - piece));
+    }
+    remaining -= static_cast<size_type>(count);
+  }
 }
 
 /**
- * @brief Clear the Lariat
+ * @brief Copies count elements starting at index to output, with one copy per contiguous piece of a node.
+ *
+ * @param index Index of the first element
+ * @param count Number of elements, throws E_BAD_INDEX if index + count is past size()
+ * @param output Where the elements go, room for count elements
  */
 template<typename T, int Size>
-void Lariat<T, Size>::clear() {
-  LNode *current = head_;
-  while (current != nullptr) {
-    LNode *to_delete = current;
+void Lariat<T, Size>::copy_out(size_type index, size_type count, T *output) const {
+  if (index > size_ || count > size_ - index) {
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+  }
 
-    size_ -= current->count;
-    current = current->next;
-    delete to_delete;
+  copy_range(index, count, output);
+}
 
-    nodecount_--;
+// Batch Methods
+
+/**
+ * @brief Applies a batch of operations in order, the same as calling the operations one by one. Positional
+ * operations start walking from the node of the previous one (or the closer end), so batches with nearby or
+ * ordered positions traverse the list once. Index and Find only look up, their results are not kept.
+ *
+ * @param batch Tuples of action, position and value, positions and values are ignored where not used
+ */
+template<typename T, int Size>
+template<typename Action, typename Position, typename Value>
+void Lariat<T, Size>::apply(const std::vector<std::tuple<Action, Position, Value>> &batch) {
+  // NOTE: Automatic compaction would move elements under the cursor, it runs once after the batch instead
+  double compact_ratio = compact_ratio_;
+  compact_ratio_ = 0;
+
+  try {
+    apply_batch(batch);
+  } catch (...) {
+    compact_ratio_ = compact_ratio;
+    throw;
   }
 
-  head_ = nullptr;
-  tail_ = nullptr;
+  compact_ratio_ = compact_ratio;
+  auto_compact_step();
 }
 
 /**
- * @brief Removes all empty spaces in the data structure
+ * @brief The operations of apply(), automatic compaction is suspended by the caller
+ *
+ * @param batch Tuples of action, position and value
  */
 template<typename T, int Size>
-void Lariat<T, Size>::compact() {
-  for (LNode *current = head_; current != nullptr; current = current->next) {
-    for (LNode *inner = current->next; inner != nullptr; inner = inner->next) {
-      if (inner->count > 0) {
-
-        while (current->count != Size) {
+template<typename Action, typename Position, typename Value>
+void Lariat<T, Size>::apply_batch(const std::vector<std::tuple<Action, Position, Value>> &batch) {
+  BatchCursor cursor;
+
+  for (const std::tuple<Action, Position, Value> &op : batch) {
+    size_type position = static_cast<size_type>(std::get<1>(op));
+    T value = static_cast<T>(std::get<2>(op));
+
+    switch (static_cast<LariatAction>(std::get<0>(op))) {
+      case LariatAction::Insert:
+        if (position > size_) {
+          throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+        }
 
-          current->values[current->count] = inner->values[0];
-          ++current->count;
+        if (position == 0) {
+          push_front_at(cursor, value);
+        } else if (position == size_) {
+          push_back(value);
+        } else {
+          // NOTE: The node of the cursor keeps its first index, a split only moves elements after it
+          insert_at(seek(cursor, position), value);
+        }
+        break;
 
-          shift_down(inner, 0);
+      case LariatAction::Erase:
+        if (size_ == 0) {
+          throw LariatException(LariatException::E_DATA_ERROR, "Cannot delete in an empty Lariat");
+        }
+        if (position >= size_) {
+          throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+        }
 
-          --inner->count;
-          if (inner->count == 0) {
-            break;
+        if (position == 0) {
+          pop_front_at(cursor);
+        } else if (position == size_ - 1) {
+          pop_back_at(cursor);
+        } else {
+          ElementSearch search = seek(cursor, position);
+          if (search.node->count == 1) {
+            cursor.node = search.node->prev;
+            cursor.base -= static_cast<size_type>(cursor.node->count);
           }
+          erase_at(search);
         }
-      }
-    }
-  }
+        break;
 
-  LNode *current = tail_;
-  while (current != nullptr && current->count == 0) {
-    LNode *to_delete = current;
+      case LariatAction::Pushback: push_back(value); break;
+      case LariatAction::Pushfront: push_front_at(cursor, value); break;
 
-    tail_ = current->prev;
-    current = current->prev;
-    delete to_delete;
+      case LariatAction::Popback:
+        if (size_ == 0) {
+          throw LariatException(LariatException::E_DATA_ERROR, "Cannot delete in an empty Lariat");
+        }
+        pop_back_at(cursor);
+        break;
 
-    tail_->next = nullptr;
-    nodecount_--;
+      case LariatAction::Popfront:
+        if (size_ == 0) {
+          throw LariatException(LariatException::E_DATA_ERROR, "Cannot delete in an empty Lariat");
+        }
+        pop_front_at(cursor);
+        break;
+
+      case LariatAction::Compact:
+        compact();
+        cursor = BatchCursor();
+        break;
+
+      case LariatAction::Index:
+        if (position >= size_) {
+          throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+        }
+        seek(cursor, position);
+        break;
+
+      case LariatAction::Find: find(value); break;
+    }
   }
 }
 
-// Helper Functions
+// Cursor Methods
 
 /**
- * @brief Splits the current node so that each node has an even amount of elements after inserting a new one.
+ * @brief Creates a cursor on the element at index for repeated edits around one position, see Cursor. The element is
+ * found from the closer end of the Lariat.
  *
- * @param to_split The node to split
- * @return Pointer to the second half of the split
+ * @param index Index of the element, size() for the end
+ * @return A cursor on the element
  */
 template<typename T, int Size>
-typename Lariat<T, Size>::LNode *Lariat<T, Size>::split(LNode &to_split) {
-  LNode *second_half = create_node();
+typename Lariat<T, Size>::Cursor Lariat<T, Size>::cursor(size_type index) {
+  if (index > size_) {
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+  }
 
-  // NOTE: The count to split for
-  int expected_count = to_split.count + 1;
+  if (index == size_) {
+    return Cursor(this, tail_, tail_ == nullptr ? 0 : tail_->count, index);
+  }
 
-  // NOTE: Whether the split will be equal
-  int extra_whole = (expected_count % 2);
+  BatchCursor from;
+  ElementSearch search = seek(from, index);
+  return Cursor(this, search.node, search.index, index);
+}
 
-  int split_point = (expected_count / 2) + extra_whole;
+template<typename T, int Size>
+Lariat<T, Size>::Cursor::Cursor(Lariat *list, LNode *node, int offset, size_type index)
+    : list_(list), node_(node), offset_(offset), index_(index) {}
 
-  for (int i = 0; i < split_point - 1 - extra_whole; i++) {
-    second_half->values[i] = to_split.values[split_point + i];
-    ++second_half->count;
+/**
+ * @brief Index of the element under the cursor, size() at the end
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::Cursor::index() const {
+  return index_;
+}
+
+/**
+ * @brief Whether the cursor is past the last element
+ */
+template<typename T, int Size>
+bool Lariat<T, Size>::Cursor::at_end() const {
+  return index_ == list_->size_;
+}
+
+/**
+ * @brief The element under the cursor, throws E_BAD_INDEX at the end
+ */
+template<typename T, int Size>
+T &Lariat<T, Size>::Cursor::value() {
+  if (at_end()) {
+    throw LariatException(LariatException::E_BAD_INDEX, "Cursor is at the end");
   }
-  to_split.count = split_point;
 
-  second_half->next = to_split.next;
-  second_half->prev = &to_split;
+  list_->touch(node_);
+  return node_->value(offset_);
+}
 
-  if (to_split.next != nullptr) {
-    to_split.next->prev = second_half;
+template<typename T, int Size>
+const T &Lariat<T, Size>::Cursor::value() const {
+  if (at_end()) {
+    throw LariatException(LariatException::E_BAD_INDEX, "Cursor is at the end");
   }
-  to_split.next = second_half;
 
-  nodecount_++;
-  return second_half;
+  list_->touch(node_);
+  return node_->value(offset_);
 }
 
 /**
- * @brief Finds the element at the given index
- *
- * @param index The index to look in
- * @return A struct containing the results of the search.
+ * @brief Moves the cursor by n elements (backwards when negative), throws E_BAD_INDEX if that leaves [0, size()]
  */
 template<typename T, int Size>
-typename Lariat<T, Size>::ElementSearch Lariat<T, Size>::find_element(int index) const {
-  if (index < 0 || index >= size_) {
+void Lariat<T, Size>::Cursor::advance(std::ptrdiff_t n) {
+  size_type distance = n < 0 ? static_cast<size_type>(-n) : static_cast<size_type>(n);
+  if (n < 0 ? distance > index_ : distance > list_->size_ - index_) {
     throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
   }
+  index_ = n < 0 ? index_ - distance : index_ + distance;
+
+  // NOTE: Whole nodes are skipped by their count, the end is the position after the last element of the tail
+  while (n > 0) {
+    std::ptrdiff_t ahead = node_->count - offset_;
+    if (n < ahead || node_->next == nullptr) {
+      offset_ += static_cast<int>(n);
+      return;
+    }
 
-  int traversed_indexes = 0;
-  for (LNode *current = head_; current != nullptr; current = current->next) {
+    n -= ahead;
+    node_ = node_->next;
+    offset_ = 0;
+  }
 
-    if (traversed_indexes + current->count > index) {
-      return ElementSearch{current, index - traversed_indexes};
+  while (n < 0) {
+    if (-n <= offset_) {
+      offset_ += static_cast<int>(n);
+      return;
     }
 
-    traversed_indexes += current->count;
+    n += offset_;
+    node_ = node_->prev;
+    offset_ = node_->count;
   }
-
-  return {nullptr, 0};
 }
 
 /**
- * @brief Shifts all elements in the node up by 1 index.
- *
- * @param node The node to shift up in.
- * @param index The index to shift up from.
+ * @brief Inserts a value before the element under the cursor, the cursor stays on that element. Repeated inserts add
+ * the values in order, like typing.
  */
 template<typename T, int Size>
-void Lariat<T, Size>::shift_up(LNode *node, int index) {
-  if (node == nullptr) {
+void Lariat<T, Size>::Cursor::insert_here(const T &value) {
+  Lariat &list = *list_;
+
+  // NOTE: The ends go through push_back and push_front for the split policy, they compact on their own
+  if (index_ == list.size_) {
+    list.push_back(value);
+    node_ = list.tail_;
+    offset_ = node_->count;
+    ++index_;
+    return;
+  }
+
+  if (index_ == 0) {
+    list.push_front(value);
+    *this = list.cursor(1);
     return;
   }
 
-  for (int i = index; i + 1 < Size; i++) {
-    swap(node->values[index], node->values[i + 1]);
+  list.touch(node_);
+  list.insert_at(ElementSearch{node_, offset_}, value);
+  ++offset_;
+  ++index_;
+
+  // NOTE: A full node was split, the elements from the middle of it on are in the node after it
+  if (offset_ >= node_->count) {
+    offset_ -= node_->count;
+    node_ = node_->next;
+  }
+
+  compact_step();
+}
+
+/**
+ * @brief Erases the element under the cursor and moves the cursor to the element after it. Throws E_DATA_ERROR on an
+ * empty Lariat and E_BAD_INDEX at the end.
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::Cursor::erase_here() {
+  Lariat &list = *list_;
+
+  if (list.size_ == 0) {
+    throw LariatException(LariatException::E_DATA_ERROR, "Cannot delete in an empty Lariat");
+  }
+
+  if (index_ == list.size_) {
+    throw LariatException(LariatException::E_BAD_INDEX, "Cursor is at the end");
+  }
+
+  if (index_ == 0) {
+    list.remove_front();
+    node_ = list.head_;
+    offset_ = 0;
+  } else if (index_ == list.size_ - 1) {
+    list.remove_back();
+    node_ = list.tail_;
+    offset_ = node_->count;
+  } else {
+    // NOTE: The node is neither the head nor the tail if it becomes empty, the element after it starts the next node
+    list.touch(node_);
+    LNode *next = node_->next;
+    bool released = node_->count == 1;
+    list.erase_at(ElementSearch{node_, offset_});
+
+    if (released || offset_ == node_->count) {
+      node_ = next;
+      offset_ = 0;
+    }
+  }
+
+  compact_step();
+}
+
+/**
+ * @brief Runs the automatic compaction after an edit and finds the index again when it ran
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::Cursor::compact_step() {
+  if (list_->auto_compact_step()) {
+    *this = list_->cursor(index_);
   }
 }
 
+// Text Methods (Lariat<char, N> only)
+
 /**
- * @brief Shifts all elements in the node down by 1 index.
+ * @brief Inserts a string before the element at index. The elements of the node after index are set aside and
+ * appended again after the text, the text fills the node and new full nodes, all with one copy per node.
  *
- * @param node The node to shift down in.
- * @param index The index to shift down from.
+ * @param index Location to insert, size() appends
+ * @param text Characters to insert
  */
 template<typename T, int Size>
-void Lariat<T, Size>::shift_down(LNode *node, const int index) {
-  if (node == nullptr) {
+template<typename C, typename std::enable_if<std::is_same<C, char>::value, int>::type>
+void Lariat<T, Size>::insert(size_type index, std::string_view text) {
+  if (index > size_) {
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+  }
+
+  if (text.empty()) {
     return;
   }
 
-  for (int i = index; i + 1 < Size; i++) {
-    swap(node->values[i], node->values[i + 1]);
+  LNode *node = tail_;
+  std::string rest;
+  if (index < size_) {
+    BatchCursor from;
+    ElementSearch search = seek(from, index);
+    node = search.node;
+    rest.resize(static_cast<std::size_t>(node->count - search.index));
+    read_run(node, search.index, node->count - search.index, &rest[0]);
+    node->count = search.index;
+  }
+
+  if (node != nullptr) {
+    touch(node);
   }
+  node = append_run(node, text.data(), text.size());
+  append_run(node, rest.data(), rest.size());
+
+  size_ += text.size();
+  auto_compact_step();
 }
 
 /**
- * @brief Factory method for a node. This will throw an exception if it fails.
+ * @brief Copies up to count characters starting at index into a string, with one copy per node.
+ *
+ * @param index Index of the first character, throws E_BAD_INDEX if it is past size()
+ * @param count Maximum number of characters
+ * @return The characters
  */
 template<typename T, int Size>
-typename Lariat<T, Size>::LNode *Lariat<T, Size>::create_node() const {
-  LNode *output = nullptr;
-  try {
-    output = new LNode;
+std::string Lariat<T, Size>::substr(size_type index, size_type count) const {
+  static_assert(std::is_same<T, char>::value, "Text methods need a Lariat<char, N>");
 
-  } catch (const std::bad_alloc &) {
-    throw LariatException(LariatException::E_NO_MEMORY, "Unable to allocate a new node. Check if memory is leaking.");
+  if (index > size_) {
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
   }
 
+  std::string output(count < size_ - index ? count : size_ - index, '\0');
+  if (!output.empty()) {
+    copy_range(index, output.size(), &output[0]);
+  }
   return output;
 }
 
-#if 1
+/**
+ * @brief Finds a string, including matches that span several nodes. Every node is searched with
+ * std::string_view::find, the characters around the boundaries of the nodes are searched separately.
+ *
+ * @param text The string to find
+ * @param from Index to start at
+ * @return Index of the first character of the first match at or after from, size() if not found
+ */
 template<typename T, int Size>
-std::ostream &operator<<(std::ostream &os, Lariat<T, Size> const &list) {
-  typename Lariat<T, Size>::LNode *current = list.head_;
-  int index = 0;
-  while (current) {
-    os << "Node starting (count " << current->count << ")\n";
-    for (int local_index = 0; local_index < current->count; ++local_index) {
-      os << index << " -> " << current->values[local_index] << std::endl;
-      ++index;
-    }
-    os << "-----------\n";
-    current = current->next;
+template<typename C, typename std::enable_if<std::is_same<C, char>::value, int>::type>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::find(std::string_view text, size_type from) const {
+  if (text.empty()) {
+    return from < size_ ? from : size_;
+  }
+  if (from >= size_ || text.size() > size_ - from) {
+    return size_;
   }
-  return os;
-}
-#else // fancier
 
-#endif
+  // NOTE: carry holds the last text.size() - 1 characters before the piece being searched, a match starting in them
+  // ends in the piece
+  const size_type keep = text.size() - 1;
+  std::string carry;
+  size_type carry_base = from, base = from, found = size_;
+
+  auto search = [&](const char *data, size_type length) {
+    std::string_view piece(data, length);
+    if (!carry.empty()) {
+      size_type carried = carry.size();
+      carry.append(piece.substr(0, keep));
+      size_type at = std::string_view(carry).find(text);
+      if (at < carried) {
+        found = carry_base + at;
+        return true;
+      }
+      carry.resize(carried);
+    }
+
+    size_type at = piece.find(text);
+    if (at != std::string_view::npos) {
+      found = base + at;
+      return true;
+    }
+
+    if (length >= keep) {
+      carry.assign(piece.substr(length - keep));
+    } else {
+      carry.append(piece);
+      if (carry.size() > keep) {
+        carry.erase(0, carry.size() - keep);
+      }
+    }
+    base += length;
+    carry_base = base - carry.size();
+    return false;
+  };
+
+  BatchCursor cursor;
+  ElementSearch start = seek(cursor, from);
+  int offset = start.index;
+  for (const LNode *node = start.node; node != nullptr; node = node->next) {
+    touch(node);
+
+    // NOTE: The elements are in at most two contiguous pieces of the ring
+    int begin = node->start + offset < Size ? node->start + offset : node->start + offset - Size;
+    int remaining = node->count - offset;
+    int end = begin + remaining < Size ? begin + remaining : Size;
+    if (search(node->values + begin, static_cast<size_type>(end - begin)) ||
+        (remaining > end - begin && search(node->values, static_cast<size_type>(remaining - (end - begin))))) {
+      return found;
+    }
+    offset = 0;
+  }
+
+  return size_;
+}
+
+/**
+ * @brief Keeps the number of newlines of every node, so that line lookups only count the nodes accessed since the
+ * previous lookup. Without it every lookup counts the newlines of all the nodes it passes.
+ *
+ * @param on Whether to keep the counts
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::track_lines(bool on) {
+  static_assert(std::is_same<T, char>::value, "Text methods need a Lariat<char, N>");
+
+  if (!on) {
+    delete lines_;
+    lines_ = nullptr;
+  } else if (lines_ == nullptr) {
+    lines_ = new std::unordered_map<const LNode *, size_type>();
+  }
+}
+
+/**
+ * @brief Number of lines, the number of newlines plus one
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::line_count() const {
+  static_assert(std::is_same<T, char>::value, "Text methods need a Lariat<char, N>");
+
+  size_type lines = 1;
+  for (const LNode *node = head_; node != nullptr; node = node->next) {
+    lines += newlines(node);
+  }
+  return lines;
+}
+
+/**
+ * @brief Index of the first character of a line, throws E_BAD_INDEX if there are not that many lines
+ *
+ * @param line Line number, starting at 0
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::line_start(size_type line) const {
+  static_assert(std::is_same<T, char>::value, "Text methods need a Lariat<char, N>");
+
+  if (line == 0) {
+    return 0;
+  }
+
+  size_type seen = 0, base = 0;
+  for (const LNode *node = head_; node != nullptr; node = node->next) {
+    size_type count = newlines(node);
+    if (seen + count >= line) {
+      touch(node);
+      for (int i = 0; i < node->count; i++) {
+        if (node->value(i) == '\n' && ++seen == line) {
+          return base + static_cast<size_type>(i) + 1;
+        }
+      }
+    }
+
+    seen += count;
+    base += static_cast<size_type>(node->count);
+  }
+
+  throw LariatException(LariatException::E_BAD_INDEX, "Line is out of range");
+}
+
+/**
+ * @brief Line of the character at index, throws E_BAD_INDEX if index is past size()
+ *
+ * @param index Index of the character, size() for the end
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::line_of(size_type index) const {
+  static_assert(std::is_same<T, char>::value, "Text methods need a Lariat<char, N>");
+
+  if (index > size_) {
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+  }
+
+  size_type line = 0, base = 0;
+  for (const LNode *node = head_; node != nullptr; node = node->next) {
+    size_type count = static_cast<size_type>(node->count);
+    if (index < base + count) {
+      touch(node);
+      for (int i = 0; i < static_cast<int>(index - base); i++) {
+        line += node->value(i) == '\n';
+      }
+      return line;
+    }
+
+    line += newlines(node);
+    base += count;
+  }
+
+  return line;
+}
+
+// Parallel Methods
+
+/**
+ * @brief Calls f on every element. Large lists are split into runs of nodes that are visited on several threads,
+ * so f has to be safe to call concurrently; within a run the elements are visited in order.
+ *
+ * @param f Function taking a T&
+ */
+template<typename T, int Size>
+template<typename F>
+void Lariat<T, Size>::for_each(F f) {
+  std::vector<LNode *> firsts = runs(size_);
+  LariatParallel::run(firsts.size() - 1, [&](std::size_t run) { visit(firsts[run], firsts[run + 1], 0, f); });
+}
+
+/**
+ * @brief Calls f on every element, see for_each.
+ *
+ * @param f Function taking a const T&
+ */
+template<typename T, int Size>
+template<typename F>
+void Lariat<T, Size>::for_each(F f) const {
+  std::vector<LNode *> firsts = runs(size_);
+  LariatParallel::run(firsts.size() - 1, [&](std::size_t run) {
+    auto g = [&f](const T &value) { f(value); };
+    visit(firsts[run], firsts[run + 1], 0, g);
+  });
+}
+
+/**
+ * @brief Replaces every element with f(element), on several threads for large lists.
+ *
+ * @param f Function taking a const T& and returning the new value
+ */
+template<typename T, int Size>
+template<typename F>
+void Lariat<T, Size>::transform_inplace(F f) {
+  std::vector<LNode *> firsts = runs(size_);
+  LariatParallel::run(firsts.size() - 1, [&](std::size_t run) {
+    auto g = [&f](T &value) { value = f(static_cast<const T &>(value)); };
+    visit(firsts[run], firsts[run + 1], 0, g);
+  });
+}
+
+/**
+ * @brief Folds the elements with op, on several threads for large lists. Every run is folded on its own and the
+ * partial results are folded in order, so the result is the one of a sequential fold when op is associative.
+ *
+ * @param init Starting value
+ * @param op Binary operation
+ * @return init folded with every element
+ */
+template<typename T, int Size>
+template<typename R, typename BinaryOp>
+R Lariat<T, Size>::reduce(R init, BinaryOp op) const {
+  return transform_reduce(init, op, [](const T &value) -> const T & { return value; });
+}
+
+/**
+ * @brief Folds transform(element) for every element with reduce, on several threads for large lists, see reduce.
+ *
+ * @param init Starting value
+ * @param reduce Binary operation
+ * @param transform Function taking a const T&
+ * @return init folded with every transformed element
+ */
+template<typename T, int Size>
+template<typename R, typename BinaryOp, typename UnaryOp>
+R Lariat<T, Size>::transform_reduce(R init, BinaryOp reduce, UnaryOp transform) const {
+  std::vector<LNode *> firsts = runs(size_);
+  if (firsts.size() <= 2) {
+    auto fold = [&](const T &value) { init = reduce(init, transform(value)); };
+    visit(head_, nullptr, 0, fold);
+    return init;
+  }
+
+  // NOTE: A run starts from its first element rather than init, init is folded in once at the end
+  std::vector<R> partials;
+  partials.reserve(firsts.size() - 1);
+  for (std::size_t run = 0; run + 1 < firsts.size(); run++) {
+    partials.push_back(static_cast<R>(transform(firsts[run]->value(0))));
+  }
+
+  LariatParallel::run(partials.size(), [&](std::size_t run) {
+    R partial = partials[run];
+    BinaryOp op = reduce;
+    auto fold = [&](const T &value) { partial = op(partial, transform(value)); };
+    visit(firsts[run], firsts[run + 1], 1, fold);
+    partials[run] = partial;
+  });
+
+  for (const R &partial : partials) {
+    init = reduce(init, partial);
+  }
+  return init;
+}
+
+// Sorting Methods
+
+/**
+ * @brief Sorts the elements in ascending order. Every node is sorted on its own (on several threads for large lists),
+ * then the sorted nodes are merged pairwise into full nodes, reusing the nodes that have been read.
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::sort() {
+  sort(std::less<T>());
+}
+
+/**
+ * @brief Sorts the elements with comp, see sort(). comp must not throw.
+ *
+ * @param comp Strict weak ordering of two const T&
+ */
+template<typename T, int Size>
+template<typename Compare>
+void Lariat<T, Size>::sort(Compare comp) {
+  sort_nodes(comp, false);
+}
+
+/**
+ * @brief Sorts the elements in ascending order, keeping the order of equal elements.
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::stable_sort() {
+  stable_sort(std::less<T>());
+}
+
+/**
+ * @brief Sorts the elements with comp keeping the order of equal elements, see sort(). comp must not throw.
+ *
+ * @param comp Strict weak ordering of two const T&
+ */
+template<typename T, int Size>
+template<typename Compare>
+void Lariat<T, Size>::stable_sort(Compare comp) {
+  sort_nodes(comp, true);
+}
+
+// Serialization Methods
+
+/**
+ * @brief Writes the Lariat in the versioned binary format (header followed by the packed values of every node).
+ *
+ * @param os Binary stream to write to
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::save(std::ostream &os) const {
+  static_assert(std::is_trivially_copyable<T>::value, "The binary format requires a trivially copyable T");
+
+  BinaryHeader header;
+  header.count = static_cast<std::uint64_t>(size_);
+  os.write(reinterpret_cast<const char *>(&header), sizeof(BinaryHeader));
+
+  // NOTE: At most two bulk writes per node (the values wrap around the end of the array), empty slots are not stored
+  for (LNode *current = head_; current != nullptr && os; current = current->next) {
+    touch(current);
+    int first_part = current->count < Size - current->start ? current->count : Size - current->start;
+    os.write(
+        reinterpret_cast<const char *>(current->values + current->start),
+        static_cast<std::streamsize>(sizeof(T)) * static_cast<std::streamsize>(first_part));
+    os.write(
+        reinterpret_cast<const char *>(current->values),
+        static_cast<std::streamsize>(sizeof(T)) * static_cast<std::streamsize>(current->count - first_part));
+  }
+
+  if (!os) {
+    throw LariatException(LariatException::E_DATA_ERROR, "Unable to write the Lariat to the stream");
+  }
+}
+
+/**
+ * @brief Replaces the contents of the Lariat with the ones stored in the binary format. Nodes are filled completely.
+ *
+ * @param is Binary stream to read from
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::load(std::istream &is) {
+  static_assert(std::is_trivially_copyable<T>::value, "The binary format requires a trivially copyable T");
+
+  const BinaryHeader expected;
+  BinaryHeader header;
+  is.read(reinterpret_cast<char *>(&header), sizeof(BinaryHeader));
+
+  if (!is || std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+      header.version != expected.version) {
+    throw LariatException(LariatException::E_DATA_ERROR, "Stream does not contain a Lariat");
+  }
+
+  if (header.value_size != expected.value_size) {
+    throw LariatException(LariatException::E_DATA_ERROR, "Element size of the stream does not match the Lariat");
+  }
+
+  if (static_cast<size_type>(header.count) != header.count) {
+    throw LariatException(LariatException::E_DATA_ERROR, "Stream contains more elements than a Lariat can hold");
+  }
+
+  clear();
+
+  size_type remaining = static_cast<size_type>(header.count);
+  while (remaining > 0) {
+    LNode *node = create_node();
+    node->prev = tail_;
+
+    // NOTE: Linking before reading so that clear() releases the node if the stream ends early
+    if (tail_ == nullptr) {
+      head_ = node;
+    } else {
+      tail_->next = node;
+    }
+    tail_ = node;
+    nodecount_++;
+
+    int to_read = remaining < static_cast<size_type>(Size) ? static_cast<int>(remaining) : Size;
+    std::streamsize bytes = static_cast<std::streamsize>(sizeof(T)) * to_read;
+
+    is.read(reinterpret_cast<char *>(node->values), bytes);
+    if (is.gcount() != bytes) {
+      clear();
+      throw LariatException(LariatException::E_DATA_ERROR, "Stream ended before all the elements were read");
+    }
+
+    node->count = to_read;
+    size_ += static_cast<size_type>(to_read);
+    remaining -= static_cast<size_type>(to_read);
+  }
+}
+
+/**
+ * @brief Appends the numbers of a text stream, the same as reading them with >> and calling push_back, for arithmetic T
+ * other than bool and the character types, which >> reads as characters. The stream is read in large blocks, numbers
+ * are parsed with std::from_chars straight into the nodes, which are filled completely. Numbers are separated by the
+ * delimiter or whitespace, empty fields are skipped. Throws E_DATA_ERROR for text that is not a number of type T, the
+ * numbers before it stay appended. A negative number for unsigned T throws E_DATA_ERROR as well, where >> wraps it
+ * around ("-1" gives the largest value).
+ *
+ * @param is Text stream to read to the end
+ * @param delimiter Character between the numbers besides whitespace
+ * @return Number of values appended
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::read_from(std::istream &is, char delimiter) {
+  return read_text(
+      [&is](char *buffer, std::size_t capacity) {
+        is.read(buffer, static_cast<std::streamsize>(capacity));
+        if (is.bad()) {
+          throw LariatException(LariatException::E_DATA_ERROR, "Cannot read from the stream");
+        }
+        return static_cast<std::size_t>(is.gcount());
+      },
+      delimiter);
+}
+
+/**
+ * @brief Appends the numbers read from a file descriptor until end of file, see read_from(std::istream &, char).
+ *
+ * @param fd File descriptor to read to the end
+ * @param delimiter Character between the numbers besides whitespace
+ * @return Number of values appended
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::read_from(int fd, char delimiter) {
+  return read_text(
+      [fd](char *buffer, std::size_t capacity) {
+        ssize_t bytes;
+        do {
+          bytes = ::read(fd, buffer, capacity);
+        } while (bytes < 0 && errno == EINTR);
+
+        if (bytes < 0) {
+          throw LariatException(LariatException::E_DATA_ERROR, "Cannot read from the file descriptor");
+        }
+        return static_cast<std::size_t>(bytes);
+      },
+      delimiter);
+}
+
+/**
+ * @brief The parsing of read_from, blocks of text come from read.
+ *
+ * @param read Function taking a char* and a std::size_t capacity, returns the number of bytes read (0 at the end)
+ * @param delimiter Character between the numbers besides whitespace
+ * @return Number of values appended
+ */
+template<typename T, int Size>
+template<typename Read>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::read_text(Read read, char delimiter) {
+  static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value,
+                "read_from parses numbers, T has to be an arithmetic type other than bool");
+  static_assert(!std::is_same<T, char>::value && !std::is_same<T, signed char>::value &&
+                    !std::is_same<T, unsigned char>::value && !std::is_same<T, wchar_t>::value &&
+                    !std::is_same<T, char16_t>::value && !std::is_same<T, char32_t>::value,
+                "read_from parses numbers, >> reads character types as characters, use a wider integer type");
+
+  auto separator = [delimiter](char c) {
+    return c == delimiter || c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+  };
+
+  const std::size_t capacity = std::size_t{1} << 20;
+  std::vector<char> buffer(capacity);
+  std::size_t used = 0;
+  size_type appended = 0;
+
+  LNode *node = tail_;
+  if (node != nullptr) {
+    touch(node);
+  }
+
+  for (bool done = false; !done;) {
+    std::size_t bytes = read(buffer.data() + used, capacity - used);
+    done = bytes == 0;
+    used += bytes;
+
+    // NOTE: Only the text up to the last separator is parsed, the number after it may go on in the next block
+    const char *begin = buffer.data();
+    const char *end = begin + used;
+    if (!done) {
+      while (end != begin && !separator(end[-1])) {
+        --end;
+      }
+      if (end == begin) {
+        if (used == capacity) {
+          throw LariatException(LariatException::E_DATA_ERROR, "Number is longer than the read buffer");
+        }
+        continue;
+      }
+    }
+
+    for (const char *text = begin; text != end;) {
+      if (separator(*text)) {
+        ++text;
+        continue;
+      }
+
+      // NOTE: from_chars does not take the leading + that >> accepts
+      if (*text == '+' && text + 1 != end && text[1] != '-') {
+        ++text;
+      }
+
+      T value;
+      std::from_chars_result parsed = std::from_chars(text, end, value);
+      if (parsed.ec == std::errc::result_out_of_range) {
+        throw LariatException(LariatException::E_DATA_ERROR, "Number is out of range of the element type");
+      }
+      if (parsed.ec != std::errc() || (parsed.ptr != end && !separator(*parsed.ptr))) {
+        throw LariatException(LariatException::E_DATA_ERROR, "Text is not a number of the element type");
+      }
+      text = parsed.ptr;
+
+      if (node == nullptr || node->count == Size) {
+        node = link_node(node, true);
+        tail_ = node;
+      }
+      node->value(node->count) = value;
+      ++node->count;
+      ++size_;
+      ++appended;
+    }
+
+    used -= static_cast<std::size_t>(end - begin);
+    std::copy(end, end + used, buffer.data());
+  }
+
+  return appended;
+}
+
+// Miscelaneous Methods
+
+/**
+ * @brief Retrieve the element where value T is
+ *
+ * @return The amount of elements contained in the data structure
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::size() const {
+  return size_;
+}
+
+/**
+ * @brief Clear the Lariat
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::clear() {
+  LNode *current = head_;
+  while (current != nullptr) {
+    LNode *to_delete = current;
+
+    size_ -= static_cast<size_type>(current->count);
+    current = current->next;
+    destroy_node(to_delete);
+
+    nodecount_--;
+  }
+
+  head_ = nullptr;
+  tail_ = nullptr;
+}
+
+/**
+ * @brief Removes all empty spaces in the data structure
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::compact() {
+  // NOTE: One unbounded step from the head
+  compact_from_ = nullptr;
+  compact_step(std::numeric_limits<size_type>::max());
+}
+
+/**
+ * @brief Does a bounded part of compact(): fills nodes with the first elements of the next node and releases the
+ * nodes that become empty. Every call continues where the previous one stopped.
+ *
+ * @param budget Maximum number of nodes visited plus elements moved
+ * @return Whether the end of the Lariat was reached, the next call starts again from the head
+ */
+template<typename T, int Size>
+bool Lariat<T, Size>::compact_step(size_type budget) {
+  LNode *node = compact_from_ != nullptr ? compact_from_ : head_;
+  size_type work = 0;
+
+  while (node != nullptr && node->next != nullptr && work < budget) {
+    LNode *next = node->next;
+    ++work;
+
+    if (node->count == Size) {
+      node = next;
+      continue;
+    }
+
+    touch(node);
+    touch(next);
+    while (node->count < Size && next->count > 0 && work < budget) {
+      node->value(node->count) = next->value(0);
+      ++node->count;
+
+      shift_down(next, 0);
+      --next->count;
+      ++work;
+    }
+
+    if (next->count == 0) {
+      LARIAT_COUNT(merges, 1);
+
+      node->next = next->next;
+      if (next->next != nullptr) {
+        next->next->prev = node;
+      } else {
+        tail_ = node;
+      }
+
+      destroy_node(next);
+      nodecount_--;
+    }
+  }
+
+  bool done = node == nullptr || node->next == nullptr;
+  compact_from_ = done ? nullptr : node;
+  return done;
+}
+
+/**
+ * @brief Compacts automatically after every insertion or removal that leaves the Lariat with fewer elements than
+ * min_occupancy of its capacity, a bounded compact_step at a time.
+ *
+ * @param min_occupancy Ratio of elements to capacity to keep (0 turns automatic compaction off)
+ * @param budget Work allowed per operation, see compact_step
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::auto_compact(double min_occupancy, size_type budget) {
+  compact_ratio_ = min_occupancy;
+  compact_budget_ = budget;
+}
+
+/**
+ * @brief Sets how full nodes are split, only affects elements added afterwards
+ *
+ * @param policy The split policy to use
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::split_policy(LariatSplit policy) {
+  split_ = policy;
+}
+
+/**
+ * @brief Makes sure that at least n elements fit in the nodes of the Lariat and its spare nodes. The missing nodes are
+ * allocated right away and kept as spare nodes until insertions need them.
+ *
+ * @param n Number of elements to make room for
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::reserve(size_type n) {
+  while (capacity() < n) {
+    LNode *node = allocate_node();
+    node->next = spare_;
+    spare_ = node;
+    ++spare_count_;
+  }
+}
+
+/**
+ * @brief Compacts the Lariat and releases the spare nodes
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::shrink_to_fit() {
+  compact();
+  release_spares();
+}
+
+/**
+ * @brief Number of elements that fit in the nodes of the Lariat and its spare nodes
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::capacity() const {
+  return (nodecount_ + spare_count_) * static_cast<size_type>(Size);
+}
+
+/**
+ * @brief Number of nodes holding the elements (spare nodes are not included)
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::node_count() const {
+  return nodecount_;
+}
+
+/**
+ * @brief Moves the nodes into a memory mapped backing file. Only the most recently used nodes stay in memory, the
+ * rest are written back to the file and faulted back in when accessed.
+ *
+ * @param path Location of the backing file
+ * @param resident_limit Amount of bytes of nodes that are allowed to stay in memory
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::spill_to(const char *path, size_t resident_limit) {
+  if (spill_ != nullptr) {
+    throw LariatException(LariatException::E_DATA_ERROR, "Lariat is already spilling to a backing file");
+  }
+
+  if (cold_ != nullptr) {
+    throw LariatException(LariatException::E_DATA_ERROR, "Lariat with packed nodes cannot spill");
+  }
+
+  // NOTE: Spare nodes are on the heap, reserve() allocates new ones from the backing file
+  release_spares();
+  spill_ = new LariatSpillFile(path, sizeof(LNode), resident_limit);
+
+  // NOTE: Relocating the existing nodes into the backing file, the heap copies are released right away
+  LNode *previous = nullptr;
+  for (LNode *current = head_; current != nullptr;) {
+    LNode *moved = create_node();
+    moved->count = current->count;
+    for (int i = 0; i < current->count; i++) {
+      moved->value(i) = std::move(current->value(i));
+    }
+
+    moved->prev = previous;
+    if (previous == nullptr) {
+      head_ = moved;
+    } else {
+      previous->next = moved;
+    }
+    previous = moved;
+
+    LNode *to_delete = current;
+    current = current->next;
+    if (inline_node_ && to_delete == reinterpret_cast<LNode *>(inline_storage_)) {
+      to_delete->~LNode();
+    } else {
+      delete to_delete;
+    }
+  }
+  inline_used_ = false;
+  tail_ = previous;
+  compact_from_ = nullptr;
+}
+
+/**
+ * @brief Amount of bytes of nodes kept in memory while spilling (0 if the Lariat is not spilling)
+ */
+template<typename T, int Size>
+size_t Lariat<T, Size>::spill_resident_bytes() const {
+  return spill_ == nullptr ? 0 : spill_->resident_bytes();
+}
+
+/**
+ * @brief Packs the values of the nodes that have not been used recently, for integral T. A packed node stores its
+ * values relative to their minimum (or as deltas, whichever is smaller) with as few bits as they need, and gives
+ * the whole memory pages inside its values back to the system; it is unpacked the next time it is accessed. Only
+ * nodes spanning several pages save memory. References to elements stay valid until 4 other nodes are accessed.
+ *
+ * @param hot_nodes Number of most recently used nodes left unpacked (at least 4), 0 unpacks everything and stops
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::compress_cold(size_type hot_nodes) {
+  static_assert(std::is_integral<T>::value, "Packing nodes requires an integral T");
+
+  if (spill_ != nullptr) {
+    throw LariatException(LariatException::E_DATA_ERROR, "Lariat spilling to a backing file cannot pack nodes");
+  }
+
+  if (hot_nodes == 0) {
+    if (cold_ != nullptr) {
+      for (LNode *current = head_; current != nullptr; current = current->next) {
+        unpack_node(current);
+      }
+      delete cold_;
+      cold_ = nullptr;
+    }
+    return;
+  }
+
+  if (cold_ == nullptr) {
+    cold_ = new ColdNodes();
+  }
+
+  // NOTE: Internal operations hold up to 4 nodes at once (merging two runs into a third one)
+  cold_->hot_limit = hot_nodes < 4 ? 4 : hot_nodes;
+  cold_->last = nullptr;
+
+  // NOTE: Visiting every node from the head leaves the last hot_nodes unpacked and packs the rest
+  for (LNode *current = head_; current != nullptr; current = current->next) {
+    touch(current);
+  }
+}
+
+/**
+ * @brief Retrieves the counters collected so far along with the current occupancy of the nodes
+ */
+template<typename T, int Size>
+LariatStats Lariat<T, Size>::stats() const {
+#ifdef LARIAT_NO_STATS
+  LariatStats output;
+#else
+  LariatStats output = stats_;
+#endif
+  output.nodes = nodecount_;
+  output.node_bytes = sizeof(LNode);
+  if (cold_ != nullptr) {
+    output.packed_nodes = cold_->packed.size();
+    output.packed_bytes = cold_->packed_bytes;
+    output.unpacked_bytes = cold_->unpacked_bytes;
+  }
+
+  for (LNode *current = head_; current != nullptr; current = current->next) {
+    int bucket = current->count * LariatStats::buckets / Size;
+    output.occupancy[bucket < LariatStats::buckets ? bucket : LariatStats::buckets - 1]++;
+  }
+
+  return output;
+}
+
+/**
+ * @brief Sets all the counters back to 0
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::reset_stats() {
+#ifndef LARIAT_NO_STATS
+  stats_ = LariatStats();
+#endif
+}
+
+// Helper Functions
+
+/**
+ * @brief Splits the current node so that each node has an even amount of elements after inserting a new one.
+ *
+ * @param to_split The node to split
+ * @return Pointer to the second half of the split
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::LNode *Lariat<T, Size>::split(LNode &to_split) {
+  LNode *second_half = create_node();
+  LARIAT_COUNT(splits, 1);
+
+  // NOTE: The count to split for
+  int expected_count = to_split.count + 1;
+
+  // NOTE: Whether the split will be equal
+  int extra_whole = (expected_count % 2);
+
+  int split_point = (expected_count / 2) + extra_whole;
+
+  for (int i = 0; i < split_point - 1 - extra_whole; i++) {
+    second_half->value(i) = to_split.value(split_point + i);
+    ++second_half->count;
+  }
+  to_split.count = split_point;
+
+  second_half->next = to_split.next;
+  second_half->prev = &to_split;
+
+  if (to_split.next != nullptr) {
+    to_split.next->prev = second_half;
+  }
+  to_split.next = second_half;
+
+  nodecount_++;
+  return second_half;
+}
+
+/**
+ * @brief Links a new empty node before or after the given node.
+ *
+ * @param node The node to link next to, nullptr for an empty Lariat
+ * @param after Whether the new node goes after node
+ * @return Pointer to the new node
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::LNode *Lariat<T, Size>::link_node(LNode *node, bool after) {
+  LNode *output = create_node();
+  nodecount_++;
+
+  if (node == nullptr) {
+    head_ = output;
+    tail_ = output;
+    return output;
+  }
+
+  if (after) {
+    output->prev = node;
+    output->next = node->next;
+    if (node->next != nullptr) {
+      node->next->prev = output;
+    }
+    node->next = output;
+  } else {
+    output->next = node;
+    output->prev = node->prev;
+    if (node->prev != nullptr) {
+      node->prev->next = output;
+    }
+    node->prev = output;
+  }
+
+  return output;
+}
+
+/**
+ * @brief Finds the element at the given index starting from the cursor or from the closer end of the Lariat, and
+ * moves the cursor to the node of the element. The caller checks that the index is in range.
+ *
+ * @param cursor Node and index of its first element where the previous search ended
+ * @param index The index to look in
+ * @return A struct containing the results of the search.
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::ElementSearch Lariat<T, Size>::seek(BatchCursor &cursor, size_type index) const {
+  LARIAT_COUNT(lookups, 1);
+
+  size_type tail_base = size_ - static_cast<size_type>(tail_->count);
+  size_type from_tail = tail_base > index ? tail_base - index : 0;
+  size_type from_cursor = cursor.node == nullptr ? size_
+                          : cursor.base > index  ? cursor.base - index
+                                                 : index - cursor.base;
+
+  if (index <= from_cursor || from_tail <= from_cursor) {
+    cursor = index <= from_tail ? BatchCursor{head_, 0} : BatchCursor{tail_, tail_base};
+  }
+
+  LNode *node = cursor.node;
+  size_type base = cursor.base;
+  LARIAT_COUNT(nodes_traversed, 1);
+
+  while (index < base) {
+    node = node->prev;
+    base -= static_cast<size_type>(node->count);
+    LARIAT_COUNT(nodes_traversed, 1);
+  }
+
+  while (index >= base + static_cast<size_type>(node->count)) {
+    base += static_cast<size_type>(node->count);
+    node = node->next;
+    LARIAT_COUNT(nodes_traversed, 1);
+  }
+
+  cursor = BatchCursor{node, base};
+  touch(node);
+  return ElementSearch{node, static_cast<int>(index - base)};
+}
+
+/**
+ * @brief push_front that keeps the cursor of apply() valid
+ *
+ * @param cursor The cursor to update
+ * @param value Value to insert
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::push_front_at(BatchCursor &cursor, const T &value) {
+  // NOTE: The head may be split or get a new node in front of it, the cursor starts over
+  if (cursor.node == head_) {
+    cursor = BatchCursor();
+  } else {
+    ++cursor.base;
+  }
+  push_front(value);
+}
+
+/**
+ * @brief pop_front of a non-empty Lariat that keeps the cursor of apply() valid
+ *
+ * @param cursor The cursor to update
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::pop_front_at(BatchCursor &cursor) {
+  if (cursor.node == head_) {
+    cursor = BatchCursor();
+  } else {
+    --cursor.base;
+  }
+  remove_front();
+}
+
+/**
+ * @brief pop_back of a non-empty Lariat that keeps the cursor of apply() valid
+ *
+ * @param cursor The cursor to update
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::pop_back_at(BatchCursor &cursor) {
+  if (cursor.node == tail_ && tail_->count == 1) {
+    cursor = BatchCursor();
+  }
+  remove_back();
+}
+
+/**
+ * @brief Finds the element at the given index, the caller checks that the index is in range
+ *
+ * @param index The index to look in
+ * @return A struct containing the results of the search.
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::ElementSearch Lariat<T, Size>::find_element(size_type index) const {
+  LARIAT_COUNT(lookups, 1);
+
+  size_type traversed_indexes = 0;
+  for (LNode *current = head_; current != nullptr; current = current->next) {
+    LARIAT_COUNT(nodes_traversed, 1);
+
+    size_type count = static_cast<size_type>(current->count);
+    if (traversed_indexes + count > index) {
+      touch(current);
+      return ElementSearch{current, static_cast<int>(index - traversed_indexes)};
+    }
+
+    traversed_indexes += count;
+  }
+
+  return {nullptr, 0};
+}
+
+/**
+ * @brief Opens a gap at index by moving the elements after it up or the ones before it down, whichever is shorter.
+ *
+ * @param node The node to shift up in.
+ * @param index The index to shift up from.
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::shift_up(LNode *node, int index) {
+  if (node == nullptr) {
+    return;
+  }
+
+  // NOTE: Only the live elements move, the last one is rotated into index when the node is full
+  int end = node->count < Size ? node->count : Size - 1;
+
+  // NOTE: Moving the front down instead when it is shorter, the slot before start is free (or holds the last element
+  // when the node is full) and is rotated into index
+  if (index < end - index) {
+    LARIAT_COUNT(elements_shifted, index);
+    node->start = node->start == 0 ? Size - 1 : node->start - 1;
+    for (int i = 0; i < index; i++) {
+      ::swap(node->value(i), node->value(i + 1));
+    }
+    return;
+  }
+
+  LARIAT_COUNT(elements_shifted, end - index);
+  for (int i = index; i < end; i++) {
+    ::swap(node->value(index), node->value(i + 1));
+  }
+}
+
+/**
+ * @brief Closes the gap at index by moving the elements after it down or the ones before it up, whichever is shorter.
+ *
+ * @param node The node to shift down in.
+ * @param index The index to shift down from.
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::shift_down(LNode *node, const int index) {
+  if (node == nullptr) {
+    return;
+  }
+
+  // NOTE: Moving the front up instead when it is shorter, the removed element ends up before start
+  if (index < node->count - 1 - index) {
+    LARIAT_COUNT(elements_shifted, index);
+    for (int i = index; i > 0; i--) {
+      ::swap(node->value(i), node->value(i - 1));
+    }
+    node->start = node->start == Size - 1 ? 0 : node->start + 1;
+    return;
+  }
+
+  LARIAT_COUNT(elements_shifted, node->count - 1 - index);
+  for (int i = index; i + 1 < node->count; i++) {
+    ::swap(node->value(i), node->value(i + 1));
+  }
+}
+
+/**
+ * @brief Copies count elements of a node starting at position from, with one copy per contiguous piece of the ring.
+ *
+ * @param node The node to read
+ * @param from Position of the first element in the node
+ * @param count Number of elements, from + count must not be past the count of the node
+ * @param output Where the elements go
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::read_run(const LNode *node, int from, int count, T *output) const {
+  int begin = node->start + from < Size ? node->start + from : node->start + from - Size;
+  int first = count < Size - begin ? count : Size - begin;
+  std::copy(node->values + begin, node->values + begin + first, output);
+  std::copy(node->values, node->values + (count - first), output + first);
+}
+
+/**
+ * @brief Copies elements into a node at position at, with one copy per contiguous piece of the ring. The count of the
+ * node is not changed.
+ *
+ * @param node The node to write
+ * @param at Position of the first element in the node, at + count must not be past Size
+ * @param input The elements
+ * @param count Number of elements
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::write_run(LNode *node, int at, const T *input, int count) {
+  int begin = node->start + at < Size ? node->start + at : node->start + at - Size;
+  int first = count < Size - begin ? count : Size - begin;
+  std::copy(input, input + first, node->values + begin);
+  std::copy(input + first, input + count, node->values);
+}
+
+/**
+ * @brief Appends elements after the ones of node, filling it and then new nodes linked after it. The size is not
+ * changed.
+ *
+ * @param node The node to append to, nullptr for an empty Lariat
+ * @param input The elements
+ * @param count Number of elements
+ * @return The last node written (node if count is 0)
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::LNode *Lariat<T, Size>::append_run(LNode *node, const T *input, size_type count) {
+  while (count > 0) {
+    if (node == nullptr || node->count == Size) {
+      LNode *next = link_node(node, true);
+      if (node == tail_) {
+        tail_ = next;
+      }
+      node = next;
+    }
+
+    int written = count < static_cast<size_type>(Size - node->count) ? static_cast<int>(count) : Size - node->count;
+    write_run(node, node->count, input, written);
+    node->count += written;
+    input += written;
+    count -= static_cast<size_type>(written);
+  }
+
+  return node;
+}
+
+/**
+ * @brief Copies count elements starting at index, the caller checks the range.
+ *
+ * @param index Index of the first element
+ * @param count Number of elements
+ * @param output Where the elements go
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::copy_range(size_type index, size_type count, T *output) const {
+  if (count == 0) {
+    return;
+  }
+
+  BatchCursor from;
+  ElementSearch search = seek(from, index);
+  const LNode *node = search.node;
+  int offset = search.index;
+  while (count > 0) {
+    touch(node);
+    int copied = count < static_cast<size_type>(node->count - offset) ? static_cast<int>(count) : node->count - offset;
+    read_run(node, offset, copied, output);
+    output += copied;
+    count -= static_cast<size_type>(copied);
+    node = node->next;
+    offset = 0;
+  }
+}
+
+/**
+ * @brief Number of newlines in a node, kept in lines_ when track_lines is on
+ *
+ * @param node The node to count in
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::size_type Lariat<T, Size>::newlines(const LNode *node) const {
+  if (lines_ != nullptr) {
+    auto found = lines_->find(node);
+    if (found != lines_->end()) {
+      return found->second;
+    }
+  }
+
+  touch(node);
+  int begin = node->start;
+  int end = begin + node->count < Size ? begin + node->count : Size;
+  size_type count = static_cast<size_type>(std::count(node->values + begin, node->values + end, '\n') +
+                                           std::count(node->values, node->values + (node->count - (end - begin)), '\n'));
+  if (lines_ != nullptr) {
+    lines_->emplace(node, count);
+  }
+  return count;
+}
+
+/**
+ * @brief Factory method for a node, spare nodes left by reserve() are used first. This will throw an exception if it
+ * fails.
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::LNode *Lariat<T, Size>::create_node() const {
+  if (spare_ != nullptr) {
+    LNode *output = spare_;
+    spare_ = output->next;
+    --spare_count_;
+
+    output->next = nullptr;
+    return output;
+  }
+
+  return allocate_node();
+}
+
+/**
+ * @brief Allocates a new node from the backing file, the inline storage or the heap. This will throw an exception if
+ * it fails.
+ */
+template<typename T, int Size>
+typename Lariat<T, Size>::LNode *Lariat<T, Size>::allocate_node() const {
+  LNode *output = nullptr;
+  LARIAT_COUNT(allocations, 1);
+  LARIAT_PEAK(peak_nodes, stats_.allocations - stats_.frees);
+
+  if (spill_ != nullptr) {
+    output = new (spill_->allocate()) LNode;
+    spill_->touch(output);
+    return output;
+  }
+
+  if constexpr (inline_node_) {
+    if (!inline_used_) {
+      inline_used_ = true;
+      return new (inline_storage_) LNode;
+    }
+  }
+
+  try {
+    output = new LNode;
+
+  } catch (const std::bad_alloc &) {
+    throw LariatException(LariatException::E_NO_MEMORY, "Unable to allocate a new node. Check if memory is leaking.");
+  }
+
+  return output;
+}
+
+/**
+ * @brief Releases a node created by create_node.
+ *
+ * @param node The node to release
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::destroy_node(LNode *node) const {
+  LARIAT_COUNT(frees, 1);
+
+  if (node == compact_from_) {
+    compact_from_ = nullptr;
+  }
+
+  if (cold_ != nullptr) {
+    forget_cold(node);
+  }
+
+  if (lines_ != nullptr) {
+    lines_->erase(node);
+  }
+
+  if (inline_node_ && node == reinterpret_cast<const LNode *>(inline_storage_)) {
+    node->~LNode();
+    inline_used_ = false;
+    return;
+  }
+
+  if (spill_ != nullptr) {
+    node->~LNode();
+    spill_->release(node);
+    return;
+  }
+
+  delete node;
+}
+
+/**
+ * @brief Releases the spare nodes left by reserve()
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::release_spares() {
+  while (spare_ != nullptr) {
+    LNode *to_delete = spare_;
+    spare_ = spare_->next;
+    destroy_node(to_delete);
+  }
+  spare_count_ = 0;
+}
+
+/**
+ * @brief Fills an empty Lariat with the converted elements of other. The nodes get the same counts push_back would
+ * give them, whole runs of elements are converted at once and large lists are converted in parallel.
+ *
+ * @param other The Lariat to copy
+ */
+template<typename T, int Size>
+template<typename OtherT, int OtherSize>
+void Lariat<T, Size>::copy_from(const Lariat<OtherT, OtherSize> &other) {
+  using OtherNode = typename Lariat<OtherT, OtherSize>::LNode;
+
+  // NOTE: push_back fills the tail, an even split then keeps the upper half of Size + 1 elements in the new tail, so
+  // every node but the tail ends up with the same count
+  const int kept = split_ == LariatSplit::Append ? Size : (Size + 1) / 2 + (Size + 1) % 2;
+  std::vector<LNode *> nodes;
+  for (size_type remaining = other.size_; remaining > 0;) {
+    int count = remaining <= static_cast<size_type>(Size) ? static_cast<int>(remaining) : kept;
+    tail_ = link_node(tail_, true);
+    tail_->count = count;
+    nodes.push_back(tail_);
+    size_ += static_cast<size_type>(count);
+    remaining -= static_cast<size_type>(count);
+  }
+
+  // NOTE: The bookkeeping of spilled and packed nodes is not safe to share between threads
+  std::size_t parts = spill_ == nullptr && other.spill_ == nullptr && cold_ == nullptr && other.cold_ == nullptr
+                          ? LariatParallel::parts(size_)
+                          : 1;
+  if (parts > nodes.size()) {
+    parts = nodes.size();
+  }
+  if (other.lines_ != nullptr && parts > 1) {
+    other.lines_->clear();
+  }
+
+  if (parts <= 1) {
+    const OtherNode *source = other.head_;
+    int offset = 0;
+    for (LNode *node : nodes) {
+      convert_node(node, other, source, offset);
+    }
+    auto_compact_step();
+    return;
+  }
+
+  // first element of every node of other, to find where each part starts reading
+  std::vector<const OtherNode *> sources;
+  std::vector<size_type> firsts;
+  size_type first = 0;
+  for (const OtherNode *current = other.head_; current != nullptr; current = current->next) {
+    sources.push_back(current);
+    firsts.push_back(first);
+    first += static_cast<size_type>(current->count);
+  }
+
+  LariatParallel::run(parts, [&](std::size_t part) {
+    std::size_t begin = part * nodes.size() / parts, end = (part + 1) * nodes.size() / parts;
+
+    size_type index = static_cast<size_type>(begin) * static_cast<size_type>(kept);
+    std::size_t found =
+        static_cast<std::size_t>(std::upper_bound(firsts.begin(), firsts.end(), index) - firsts.begin()) - 1;
+    const OtherNode *source = sources[found];
+    int offset = static_cast<int>(index - firsts[found]);
+    for (std::size_t i = begin; i < end; i++) {
+      convert_node(nodes[i], other, source, offset);
+    }
+  });
+  auto_compact_step();
+}
+
+/**
+ * @brief Converts the elements of other starting at the given position into a new node, and moves the position past
+ * them.
+ *
+ * @param node The node to fill, count is already set
+ * @param other The Lariat being copied
+ * @param source Node of other holding the next element
+ * @param offset Position of the next element in source
+ */
+template<typename T, int Size>
+template<typename OtherT, int OtherSize>
+void Lariat<T, Size>::convert_node(LNode *node, const Lariat<OtherT, OtherSize> &other,
+                                   const typename Lariat<OtherT, OtherSize>::LNode *&source, int &offset) const {
+  touch(node);
+
+  // NOTE: A run stops at the end of either node or where the ring of the source wraps around
+  for (int filled = 0; filled < node->count;) {
+    if (offset == source->count) {
+      source = source->next;
+      offset = 0;
+    }
+    other.touch(source);
+
+    int slot = source->start + offset < OtherSize ? source->start + offset : source->start + offset - OtherSize;
+    int run = std::min(std::min(node->count - filled, source->count - offset), OtherSize - slot);
+    lariat_convert(node->values + filled, source->values + slot, run);
+    filled += run;
+    offset += run;
+  }
+}
+
+/**
+ * @brief Sorts every node, then merges the nodes pairwise until one sorted run is left.
+ *
+ * @param comp Strict weak ordering of two const T&
+ * @param stable Whether equal elements keep their order
+ */
+template<typename T, int Size>
+template<typename Compare>
+void Lariat<T, Size>::sort_nodes(Compare &comp, bool stable) {
+  if (size_ < 2) {
+    return;
+  }
+
+  // NOTE: Rotating the ring puts the elements of a node at the front of values, merges only write from the front
+  std::vector<LNode *> firsts = runs(size_);
+  LariatParallel::run(firsts.size() - 1, [&](std::size_t run) {
+    for (LNode *node = firsts[run]; node != firsts[run + 1]; node = node->next) {
+      touch(node);
+      if (node->start != 0) {
+        std::rotate(node->values, node->values + node->start, node->values + Size);
+        node->start = 0;
+      }
+      if (stable) {
+        std::stable_sort(node->values, node->values + node->count, comp);
+      } else {
+        std::sort(node->values, node->values + node->count, comp);
+      }
+    }
+  });
+
+  std::vector<LNode *> sorted;
+  sorted.reserve(nodecount_);
+  for (LNode *node = head_; node != nullptr;) {
+    LNode *next = node->next;
+    node->next = nullptr;
+    sorted.push_back(node);
+    node = next;
+  }
+
+  // NOTE: Every part of a round merges its pairs with its own pool, the pools are refilled in between rounds
+  std::vector<LNode *> pool;
+  while (sorted.size() > 1) {
+    std::size_t pairs = sorted.size() / 2;
+    std::size_t parts = spill_ == nullptr && cold_ == nullptr ? std::min(LariatParallel::parts(size_), pairs) : 1;
+    std::vector<std::vector<LNode *>> pools(parts);
+    for (std::vector<LNode *> &part_pool : pools) {
+      while (part_pool.size() < 2) {
+        if (pool.empty()) {
+          part_pool.push_back(create_node());
+        } else {
+          part_pool.push_back(pool.back());
+          pool.pop_back();
+        }
+      }
+    }
+
+    std::vector<LNode *> merged((sorted.size() + 1) / 2);
+    LariatParallel::run(parts, [&](std::size_t part) {
+      for (std::size_t pair = part * pairs / parts; pair < (part + 1) * pairs / parts; pair++) {
+        merged[pair] = merge_runs(sorted[2 * pair], sorted[2 * pair + 1], comp, pools[part]);
+      }
+    });
+    if (sorted.size() % 2 != 0) {
+      merged.back() = sorted.back();
+    }
+
+    for (std::vector<LNode *> &part_pool : pools) {
+      pool.insert(pool.end(), part_pool.begin(), part_pool.end());
+    }
+    sorted = std::move(merged);
+  }
+
+  for (LNode *node : pool) {
+    destroy_node(node);
+  }
+
+  head_ = sorted.front();
+  head_->prev = nullptr;
+  nodecount_ = 1;
+  for (tail_ = head_; tail_->next != nullptr; tail_ = tail_->next) {
+    tail_->next->prev = tail_;
+    nodecount_++;
+  }
+  compact_from_ = nullptr;
+}
+
+/**
+ * @brief Merges two sorted runs of nodes (linked by next only) into one. Output nodes are taken from pool and the
+ * input nodes that have been read go back to it, pool has to hold 2 nodes for a merge to never run out.
+ *
+ * @param a First run, wins ties
+ * @param b Second run
+ * @param comp Strict weak ordering of two const T&
+ * @param pool Unused nodes
+ * @return First node of the merged run
+ */
+template<typename T, int Size>
+template<typename Compare>
+typename Lariat<T, Size>::LNode *Lariat<T, Size>::merge_runs(LNode *a, LNode *b, Compare &comp,
+                                                               std::vector<LNode *> &pool) const {
+  LNode *first = nullptr, *out = nullptr;
+  int index_a = 0, index_b = 0;
+
+  // NOTE: Keeps the nodes being read and written from being packed while other nodes are touched
+  auto hold = [&]() {
+    for (LNode *node : {a, b, out}) {
+      if (node != nullptr) {
+        touch(node);
+      }
+    }
+  };
+
+  auto next_out = [&]() {
+    LNode *node = pool.back();
+    pool.pop_back();
+    touch(node);
+    hold();
+    node->next = nullptr;
+    node->count = 0;
+    node->start = 0;
+    (out == nullptr ? first : out->next) = node;
+    out = node;
+  };
+
+  // NOTE: A node that has been read completely can take output right away
+  auto next_in = [&](LNode *&node, int &index) {
+    LNode *next = node->next;
+    pool.push_back(node);
+    node = next;
+    index = 0;
+    if (node != nullptr) {
+      touch(node);
+    }
+    hold();
+  };
+
+  touch(a);
+  touch(b);
+  next_out();
+  while (a != nullptr && b != nullptr) {
+    // NOTE: Runs up to the nearest node boundary without checks, the element to move is picked without a branch
+    T *from_a = a->values + index_a, *from_b = b->values + index_b, *to = out->values + out->count;
+    T *end_a = a->values + a->count, *end_b = b->values + b->count, *end_to = out->values + Size;
+    while (from_a != end_a && from_b != end_b && to != end_to) {
+      bool take_b = comp(*from_b, *from_a);
+      *to++ = std::move(take_b ? *from_b : *from_a);
+      from_b += take_b;
+      from_a += !take_b;
+    }
+    index_a = static_cast<int>(from_a - a->values);
+    index_b = static_cast<int>(from_b - b->values);
+    out->count = static_cast<int>(to - out->values);
+
+    if (index_a == a->count) {
+      next_in(a, index_a);
+    }
+    if (index_b == b->count) {
+      next_in(b, index_b);
+    }
+    if (out->count == Size && a != nullptr && b != nullptr) {
+      next_out();
+    }
+  }
+
+  // NOTE: What is left of the other run is moved until a node boundary lines up, then linked as it is
+  LNode *rest = a != nullptr ? a : b;
+  int &index = a != nullptr ? index_a : index_b;
+  while (rest != nullptr && (index != 0 || out->count != Size)) {
+    if (out->count == Size) {
+      next_out();
+    }
+    int run = std::min(rest->count - index, Size - out->count);
+    std::move(rest->values + index, rest->values + index + run, out->values + out->count);
+    out->count += run;
+    index += run;
+    if (index == rest->count) {
+      next_in(rest, index);
+    }
+  }
+  out->next = rest;
+  return first;
+}
+
+/**
+ * @brief Splits the nodes into runs holding about the same number of elements, one run per thread.
+ *
+ * @param elements Number of elements the work is about, picks the number of runs
+ * @return First node of every run followed by nullptr
+ */
+template<typename T, int Size>
+std::vector<typename Lariat<T, Size>::LNode *> Lariat<T, Size>::runs(size_type elements) const {
+  std::vector<LNode *> firsts;
+  if (head_ != nullptr) {
+    firsts.push_back(head_);
+  }
+
+  // NOTE: The bookkeeping of spilled and packed nodes is not safe to share between threads, the newline counts are
+  // dropped so that touching the nodes does not change them
+  size_type parts = spill_ == nullptr && cold_ == nullptr ? LariatParallel::parts(elements) : 1;
+  if (lines_ != nullptr && parts > 1) {
+    lines_->clear();
+  }
+  size_type seen = 0;
+  for (LNode *current = head_; parts > 1 && current->next != nullptr; current = current->next) {
+    seen += static_cast<size_type>(current->count);
+    if (seen >= firsts.size() * size_ / parts) {
+      firsts.push_back(current->next);
+      if (firsts.size() == parts) {
+        break;
+      }
+    }
+  }
+
+  firsts.push_back(nullptr);
+  return firsts;
+}
+
+/**
+ * @brief Calls f on every element of the nodes from first up to (not including) last, in order.
+ *
+ * @param first First node to visit
+ * @param last Node to stop at, nullptr for the end
+ * @param skip Number of elements of first to leave out
+ * @param f Function taking a T&
+ */
+template<typename T, int Size>
+template<typename F>
+void Lariat<T, Size>::visit(LNode *first, LNode *last, int skip, F &f) const {
+  for (LNode *current = first; current != last; current = current->next) {
+    touch(current);
+
+    // NOTE: The elements are in at most two contiguous pieces, from start up to the end of the ring and from the
+    // beginning of the ring
+    int begin = current->start + skip < Size ? current->start + skip : current->start + skip - Size;
+    int remaining = current->count - skip;
+    int end = begin + remaining < Size ? begin + remaining : Size;
+    for (T *value = current->values + begin, *stop = current->values + end; value != stop; ++value) {
+      f(*value);
+    }
+    for (T *value = current->values, *stop = current->values + (remaining - (end - begin)); value != stop; ++value) {
+      f(*value);
+    }
+    skip = 0;
+  }
+}
+
+/**
+ * @brief Runs a compact_step when automatic compaction is on and the occupancy is below the threshold.
+ *
+ * @return Whether a compact_step ran
+ */
+template<typename T, int Size>
+bool Lariat<T, Size>::auto_compact_step() {
+  if (compact_ratio_ > 0 &&
+      static_cast<double>(size_) < compact_ratio_ * static_cast<double>(nodecount_) * static_cast<double>(Size)) {
+    compact_step(compact_budget_);
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Marks the node as recently used so the backing file keeps it in memory.
+ *
+ * @param node The node that is being accessed
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::touch(const LNode *node) const {
+  if (spill_ != nullptr) {
+    spill_->touch(node);
+  }
+
+  // NOTE: The node may be changed by whoever accesses it, its newlines are counted again
+  if (lines_ != nullptr && !lines_->empty()) {
+    lines_->erase(node);
+  }
+
+  if constexpr (std::is_integral<T>::value) {
+    if (cold_ != nullptr) {
+      touch_cold(node);
+    }
+  }
+}
+
+/**
+ * @brief Moves the node to the front of the nodes left unpacked, unpacking it if needed and packing the least
+ * recently used one when there are too many.
+ *
+ * @param node The node that is being accessed
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::touch_cold(const LNode *node) const {
+  if (node == cold_->last) {
+    return;
+  }
+  cold_->last = node;
+
+  auto found = cold_->hot_index.find(node);
+  if (found != cold_->hot_index.end()) {
+    cold_->hot.splice(cold_->hot.begin(), cold_->hot, found->second);
+    return;
+  }
+
+  unpack_node(node);
+  cold_->hot.push_front(node);
+  cold_->hot_index.emplace(node, cold_->hot.begin());
+
+  if (cold_->hot_index.size() > cold_->hot_limit) {
+    const LNode *coldest = cold_->hot.back();
+    cold_->hot.pop_back();
+    cold_->hot_index.erase(coldest);
+    pack_node(coldest);
+  }
+}
+
+/**
+ * @brief Packs the values of the node and releases the memory pages inside its values, unless that saves nothing.
+ *
+ * @param node The node to pack
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::pack_node(const LNode *node) const {
+  static const std::uintptr_t page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+  std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(node->values);
+  std::uintptr_t first_page = (begin + page - 1) / page * page;
+  std::uintptr_t last_page = (begin + sizeof(node->values)) / page * page;
+  if (node->count == 0 || last_page <= first_page) {
+    return;
+  }
+
+  cold_->scratch.resize(static_cast<std::size_t>(node->count));
+  for (int i = 0; i < node->count; i++) {
+    cold_->scratch[static_cast<std::size_t>(i)] = static_cast<std::uint64_t>(node->value(i));
+  }
+  std::vector<std::uint64_t> packed;
+  lariat_pack(cold_->scratch.data(), node->count, std::is_signed<T>::value, packed);
+
+  std::size_t packed_bytes = packed.size() * sizeof(std::uint64_t);
+  if (packed_bytes >= last_page - first_page) {
+    return;
+  }
+
+  // NOTE: The released pages read back as zeros until unpack_node writes the values again
+  ::madvise(reinterpret_cast<void *>(first_page), last_page - first_page, MADV_DONTNEED);
+  cold_->packed_bytes += packed_bytes;
+  cold_->unpacked_bytes += static_cast<std::size_t>(node->count) * sizeof(T);
+  cold_->packed.emplace(node, std::move(packed));
+  LARIAT_COUNT(packs, 1);
+}
+
+/**
+ * @brief Restores the values of a packed node and drops its packed copy.
+ *
+ * @param node The node to unpack
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::unpack_node(const LNode *node) const {
+  auto found = cold_->packed.find(node);
+  if (found == cold_->packed.end()) {
+    return;
+  }
+
+  // NOTE: Touching a node is how every access starts, even the ones that only read it
+  LNode *writable = const_cast<LNode *>(node);
+  cold_->scratch.resize(static_cast<std::size_t>(node->count));
+  lariat_unpack(found->second, node->count, cold_->scratch.data());
+  for (int i = 0; i < node->count; i++) {
+    writable->value(i) = static_cast<T>(cold_->scratch[static_cast<std::size_t>(i)]);
+  }
+
+  cold_->packed_bytes -= found->second.size() * sizeof(std::uint64_t);
+  cold_->unpacked_bytes -= static_cast<std::size_t>(node->count) * sizeof(T);
+  cold_->packed.erase(found);
+  LARIAT_COUNT(unpacks, 1);
+}
+
+/**
+ * @brief Drops everything compress_cold keeps about a node that is being released.
+ *
+ * @param node The node that is being released
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::forget_cold(const LNode *node) const {
+  if (cold_->last == node) {
+    cold_->last = nullptr;
+  }
+
+  auto hot = cold_->hot_index.find(node);
+  if (hot != cold_->hot_index.end()) {
+    cold_->hot.erase(hot->second);
+    cold_->hot_index.erase(hot);
+  }
+
+  auto packed = cold_->packed.find(node);
+  if (packed != cold_->packed.end()) {
+    cold_->packed_bytes -= packed->second.size() * sizeof(std::uint64_t);
+    cold_->unpacked_bytes -= static_cast<std::size_t>(node->count) * sizeof(T);
+    cold_->packed.erase(packed);
+  }
+}
+
+/**
+ * @brief Writes the Lariat node by node through a buffer, the stream is not flushed.
+ *
+ * @param os Stream to write to
+ * @param format Layout of the output
+ */
+template<typename T, int Size>
+void Lariat<T, Size>::print(std::ostream &os, LariatFormat format) const {
+  LariatOutputBuffer out(os);
+
+  switch (format) {
+    case LariatFormat::Debug: {
+      size_type index = 0;
+      for (LNode *current = head_; current != nullptr; current = current->next) {
+        touch(current);
+        out.put("Node starting (count ");
+        out.put_value(current->count);
+        out.put(")\n");
+        for (int local_index = 0; local_index < current->count; ++local_index) {
+          out.put_value(index);
+          out.put(" -> ");
+          out.put_value(current->value(local_index));
+          out.put('\n');
+          ++index;
+        }
+        out.put("-----------\n");
+      }
+      break;
+    }
+
+    case LariatFormat::Compact: {
+      for (LNode *current = head_; current != nullptr; current = current->next) {
+        touch(current);
+        if (current != head_) {
+          out.put(" |");
+        }
+        for (int i = 0; i < current->count; i++) {
+          if (current != head_ || i > 0) {
+            out.put(' ');
+          }
+          out.put_value(current->value(i));
+        }
+      }
+      out.put('\n');
+      break;
+    }
+
+    case LariatFormat::Fancy: {
+      const int cell = 3;
+
+      out.put("Head = ");
+      out.put_address(head_);
+      out.put("     tail = ");
+      out.put_address(tail_);
+      out.put("    count = ");
+      out.put_value(nodecount_);
+      out.put("   size ");
+      out.put_value(size_);
+      out.put('\n');
+
+      if (head_ == nullptr) {
+        out.put('\n');
+        break;
+      }
+
+      // NOTE: Indices are aligned with the values of the row below
+      size_type index = 0;
+      out.put(' ');
+      for (LNode *current = head_; current != nullptr; current = current->next) {
+        for (int i = 0; i < Size; i++) {
+          if (i < current->count) {
+            out.put_value(index++, cell);
+          } else {
+            out.put(' ', cell);
+          }
+        }
+        out.put(' ', 4);
+      }
+      out.put('\n');
+
+      for (int row = 0; row < 3; row++) {
+        for (LNode *current = head_; current != nullptr; current = current->next) {
+          if (row == 1) {
+            touch(current);
+            out.put('|');
+            for (int i = 0; i < Size; i++) {
+              if (i < current->count) {
+                out.put_value(current->value(i), cell);
+              } else {
+                out.put("  -");
+              }
+            }
+            out.put("|->");
+
+          } else {
+            out.put('+');
+            out.put('-', cell * Size);
+            out.put("+  ");
+          }
+        }
+        out.put('\n');
+      }
+
+      for (LNode *current = head_; current != nullptr; current = current->next) {
+        out.put_address(current, cell * Size);
+        out.put("  ");
+      }
+      out.put('\n');
+
+      int line = 0;
+      for (LNode *current = head_; current != nullptr; current = current->next, line++) {
+        if (line > 0) {
+          out.put(' ', 6 + 14 * (line - 1));
+        }
+        out.put_address(current->prev);
+        out.put(" <-- ");
+        out.put_address(current);
+        out.put(" --> ");
+        out.put_address(current->next);
+        out.put('\n');
+      }
+      out.put('\n');
+      break;
+    }
+  }
+}
+
+template<typename T, int Size>
+std::ostream &operator<<(std::ostream &os, Lariat<T, Size> const &list) {
+  list.print(os, LariatFormat::Debug);
+  return os;
+}
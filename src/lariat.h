@@ -3,9 +3,18 @@
 #define LARIAT_H
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <cstddef> // std::size_t
+#include <cstdint> // fixed width binary header
 #include <cstring> // memcpy
+#include <iosfwd> // std::istream, std::ostream
+#include <list> // spill file LRU
 #include <string> // error strings
+#include <string_view> // text methods
+#include <tuple> // apply batches
+#include <type_traits> // text method overloads
+#include <unordered_map> // spill file LRU
 #include <utility> // error strings
+#include <vector> // spill file free slots
 
 class LariatException : public std::exception {
 private:
@@ -24,6 +33,211 @@ public:
   enum LARIAT_EXCEPTION { E_NO_MEMORY, E_BAD_INDEX, E_DATA_ERROR };
 };
 
+/**
+ * @brief Fixed size slot storage inside a memory mapped backing file. Recently touched extents of the file are kept
+ * resident, the least recently used ones are written back and released once the resident limit is exceeded.
+ */
+class LariatSpillFile {
+public:
+  /**
+   * @brief Creates the backing file and reserves the address space for the slots.
+   *
+   * @param path Location of the backing file (removed from the file system once opened)
+   * @param slot_size Size in bytes of every slot
+   * @param resident_limit Amount of bytes that are allowed to stay in memory
+   */
+  LariatSpillFile(const char *path, std::size_t slot_size, std::size_t resident_limit);
+
+  LariatSpillFile(const LariatSpillFile &) = delete;
+  LariatSpillFile &operator=(const LariatSpillFile &) = delete;
+
+  ~LariatSpillFile();
+
+  /**
+   * @brief Retrieves an unused slot, growing the backing file if needed. This will throw an exception if it fails.
+   */
+  void *allocate();
+
+  /**
+   * @brief Returns a slot so it can be reused by allocate().
+   */
+  void release(void *slot);
+
+  /**
+   * @brief Marks the extents covering the slot as most recently used, evicting the coldest ones if over the limit.
+   */
+  void touch(const void *slot);
+
+  /**
+   * @brief Amount of bytes of the extents currently tracked as resident.
+   */
+  std::size_t resident_bytes() const;
+
+private:
+  static constexpr std::size_t reserve_bytes = std::size_t{1} << 36; // address space reserved for the mapping
+  static constexpr std::size_t extent_bytes = std::size_t{1} << 16; // granularity of the eviction
+  static constexpr std::size_t growth_bytes = std::size_t{1} << 20; // granularity of the file growth
+
+  int fd_;
+  char *base_;
+  std::size_t slot_size_;
+  std::size_t file_bytes_;
+  std::size_t used_slots_;
+  std::size_t extent_limit_;
+  std::size_t last_extent_;
+  std::vector<void *> free_slots_;
+  std::list<std::size_t> lru_; // front is the most recently used extent
+  std::unordered_map<std::size_t, std::list<std::size_t>::iterator> resident_;
+
+  void touch_extent(std::size_t extent);
+  void evict(std::size_t extent);
+};
+
+/**
+ * @brief Counters collected by a Lariat while it is used. Define LARIAT_NO_STATS to compile the counting and the
+ * counters kept in every Lariat out, stats() then only reports the current nodes and their occupancy.
+ */
+struct LariatStats {
+  unsigned long long allocations{0}; // nodes created
+  unsigned long long frees{0}; // nodes released
+  unsigned long long splits{0}; // full nodes split in two
+  unsigned long long merges{0}; // nodes emptied into their neighbours
+  unsigned long long lookups{0}; // searches for an index
+  unsigned long long nodes_traversed{0}; // nodes stepped through by the searches
+  unsigned long long elements_shifted{0}; // elements moved to open or close a gap inside a node
+  unsigned long long peak_nodes{0}; // most nodes alive at the same time
+  unsigned long long packs{0}; // nodes packed by compress_cold
+  unsigned long long unpacks{0}; // packed nodes unpacked on access
+
+  std::size_t nodes{0}; // nodes currently in the list
+  std::size_t node_bytes{0}; // size of one node
+  std::size_t packed_nodes{0}; // nodes currently packed
+  std::size_t packed_bytes{0}; // memory held by the packed values
+  std::size_t unpacked_bytes{0}; // memory the packed values take unpacked
+
+  static constexpr int buckets = 10;
+  std::size_t occupancy[buckets]{}; // nodes per fill ratio, [0, 10%) to [90%, 100%]
+};
+
+std::ostream &operator<<(std::ostream &os, LariatStats const &stats);
+
+#ifdef LARIAT_NO_STATS
+  #define LARIAT_COUNT(counter, amount)
+  #define LARIAT_PEAK(counter, value)
+#else
+  #define LARIAT_COUNT(counter, amount) (stats_.counter += static_cast<unsigned long long>(amount))
+  #define LARIAT_PEAK(counter, value) \
+    (stats_.counter = stats_.counter > (value) ? stats_.counter : static_cast<unsigned long long>(value))
+#endif
+
+// Nodes up to this many bytes are embedded in the Lariat itself for the first node, bigger ones always live on the heap.
+// Every Lariat whose node fits carries the whole node even when it is empty, so this is also how much an instantiation
+// can grow: with 256, Lariat<int, 58> is 256 bytes bigger and Lariat<int, 59> does not grow at all. Define it as 0 to
+// keep every node on the heap.
+#ifndef LARIAT_INLINE_NODE_BYTES
+  #define LARIAT_INLINE_NODE_BYTES 256
+#endif
+
+/**
+ * @brief Layouts supported by Lariat::print
+ */
+enum class LariatFormat {
+  Debug, // one line per element, grouped by node (used by operator<<)
+  Compact, // all the elements on one line, nodes separated by '|'
+  Fancy // boxes for every node with their indices, addresses and links
+};
+
+/**
+ * @brief Operations of a batch given to Lariat::apply
+ */
+enum class LariatAction { Insert, Pushback, Pushfront, Compact, Erase, Popback, Popfront, Index, Find };
+
+/**
+ * @brief What happens when an element is added to a full node
+ */
+enum class LariatSplit {
+  Even, // the node is split in two halves (default)
+  Append // at the front and the back a new empty node is started, inserts in the middle split evenly
+};
+
+/**
+ * @brief Collects formatted text and hands it to the stream in large blocks. Numbers are formatted with to_chars when
+ * the stream uses the default formatting, everything else goes through the stream itself.
+ */
+class LariatOutputBuffer {
+public:
+  explicit LariatOutputBuffer(std::ostream &os);
+
+  LariatOutputBuffer(const LariatOutputBuffer &) = delete;
+  LariatOutputBuffer &operator=(const LariatOutputBuffer &) = delete;
+
+  ~LariatOutputBuffer();
+
+  void put(char c);
+  void put(const char *text);
+  void put(char c, int repeat);
+
+  /**
+   * @brief Formats a value, right aligned if width is larger than the formatted text.
+   */
+  template<typename V>
+  void put_value(const V &value, int width = 0);
+
+  /**
+   * @brief Formats an address the same way the stream does ("0" for nullptr).
+   */
+  void put_address(const void *address, int width = 0);
+
+  /**
+   * @brief Hands the collected text to the stream.
+   */
+  void flush();
+
+private:
+  static constexpr std::size_t capacity = std::size_t{1} << 16;
+  static constexpr std::size_t max_number = 64; // longest text a to_chars fast path produces
+
+  std::ostream &os_;
+  bool fast_; // whether the stream uses the default formatting
+  std::size_t used_;
+  char buffer_[capacity];
+
+  void put_padded(const char *text, std::size_t length, int width);
+};
+
+/**
+ * @brief Spreads work on the nodes of a Lariat over threads, small lists stay on the calling thread.
+ */
+class LariatParallel {
+public:
+  static constexpr std::size_t min_elements = std::size_t{1} << 16; // elements worth starting a thread for
+
+  /**
+   * @brief Sets the number of threads to use, 0 for one per hardware thread (the default)
+   */
+  static void threads(unsigned count);
+
+  /**
+   * @brief Number of threads to use
+   */
+  static unsigned threads();
+
+  /**
+   * @brief Number of parts to split n elements into, 1 when n is too small to be worth threads
+   */
+  static std::size_t parts(std::size_t n);
+
+  /**
+   * @brief Calls work(part) for every part in [0, parts), each part on its own thread. The first exception thrown by
+   * work is rethrown once every part is done.
+   */
+  template<typename F>
+  static void run(std::size_t parts, const F &work);
+
+private:
+  static unsigned &setting();
+};
+
 // forward declaration for 1-1 operator<<
 template<typename T, int Size>
 class Lariat;
@@ -39,6 +253,8 @@ public:
   template<typename S, int OtherSize>
   friend class Lariat;
 
+  using size_type = std::size_t; // type of sizes and indices
+
   // Constructors + Destructor
 
   /**
@@ -52,7 +268,8 @@ public:
   Lariat(Lariat const &rhs);
 
   /**
-   * @brief Copy assignment operator for Lariat
+   * @brief Copy assignment operator for Lariat, the split policy and the automatic compaction are copied along
+   * with the elements like the copy constructor does
    */
   Lariat &operator=(const Lariat &rhs);
 
@@ -67,7 +284,8 @@ public:
   Lariat(const Lariat<OtherT, OtherSize> &rhs);
 
   /**
-   * @brief Templatized copy assignment operator for Lariat
+   * @brief Templatized copy assignment operator for Lariat, the split policy and the automatic compaction are copied along
+   * with the elements like the copy constructor does
    */
   template<typename OtherT, int OtherSize>
   Lariat &operator=(const Lariat<OtherT, OtherSize> &rhs);
@@ -84,7 +302,15 @@ public:
    * @param index Location to insert
    * @param value Value to insert
    */
-  void insert(int index, const T &value);
+  void insert(size_type index, const T &value);
+
+  /**
+   * @brief Insert a value of type T into the Lariat without checking the index, which must be in [0, size()]
+   *
+   * @param index Location to insert
+   * @param value Value to insert
+   */
+  void insert_unchecked(size_type index, const T &value);
 
   /**
    * @brief Insert a value of T at the end of the Lariat
@@ -107,7 +333,23 @@ public:
    *
    * @param index Index of value to delete
    */
-  void erase(int index);
+  void erase(size_type index);
+
+  /**
+   * @brief Erase the value at index without checking the index, which must be in [0, size())
+   *
+   * @param index Index of value to delete
+   */
+  void erase_unchecked(size_type index);
+
+  /**
+   * @brief Erase count values starting at index. Nodes that are erased completely are released, the others move the
+   * shorter side of their remaining elements once.
+   *
+   * @param index Index of the first value to delete
+   * @param count Number of values to delete, index + count must not be past size()
+   */
+  void erase(size_type index, size_type count);
 
   /**
    * @brief Erase the last element in the Lariat
@@ -119,23 +361,64 @@ public:
    */
   void pop_front();
 
+  /**
+   * @brief Erase every element for which pred is true, in one pass that packs the remaining elements into full nodes
+   * and releases the nodes left empty. pred must not throw.
+   *
+   * @param pred Function taking a const T&
+   * @return Number of erased elements
+   */
+  template<typename Predicate>
+  size_type erase_if(Predicate pred);
+
+  /**
+   * @brief Erase every element equal to value, see erase_if.
+   *
+   * @param value The value to erase
+   * @return Number of erased elements
+   */
+  size_type remove(const T &value);
+
+  /**
+   * @brief Erase every element equal to the element before it, see erase_if.
+   *
+   * @return Number of erased elements
+   */
+  size_type unique();
+
   // Access Methods
 
   /**
-   * @brief Retrieves the element at index
+   * @brief Retrieves the element at index, the index is not checked and must be in [0, size())
    *
    * @param index The index of the element to retrieve
    * @return Reference to retrieved value
    */
-  T &operator[](int index); // for l-values
+  T &operator[](size_type index); // for l-values
 
   /**
-   * @brief Retrieves the element at index with a const reference
+   * @brief Retrieves the element at index with a const reference, the index is not checked and must be in [0, size())
    *
    * @param index The index of the element to retrieve
    * @return Const reference to retrieved value
    */
-  const T &operator[](int index) const; // for r-values
+  const T &operator[](size_type index) const; // for r-values
+
+  /**
+   * @brief Retrieves the element at index, throws E_BAD_INDEX if the index is out of range
+   *
+   * @param index The index of the element to retrieve
+   * @return Reference to retrieved value
+   */
+  T &at(size_type index);
+
+  /**
+   * @brief Retrieves the element at index with a const reference, throws E_BAD_INDEX if the index is out of range
+   *
+   * @param index The index of the element to retrieve
+   * @return Const reference to retrieved value
+   */
+  const T &at(size_type index) const;
 
   /**
    * @brief Retrieves the element at the front of the Lariat
@@ -171,10 +454,241 @@ public:
    * @param value The value to find
    * @return index of the element
    */
-  unsigned find(const T &value) const; // returns index, size (one past last) if not found
+  size_type find(const T &value) const; // returns index, size (one past last) if not found
+
+  /**
+   * @brief Calls fn with every contiguous piece of the elements in [begin, end), in order: at most two pieces per node,
+   * pointing into the node itself. The pointers are only valid during the call, fn must not change the Lariat.
+   *
+   * @param begin Index of the first element
+   * @param end Index after the last element, throws E_BAD_INDEX if begin > end or end > size()
+   * @param fn Function taking a const T* and a std::size_t number of elements
+   */
+  template<typename F>
+  void for_each_chunk(size_type begin, size_type end, F fn) const;
+
+  /**
+   * @brief Copies count elements starting at index to output, with one copy per contiguous piece of a node.
+   *
+   * @param index Index of the first element
+   * @param count Number of elements, throws E_BAD_INDEX if index + count is past size()
+   * @param output Where the elements go, room for count elements
+   */
+  void copy_out(size_type index, size_type count, T *output) const;
 
   friend std::ostream &operator<< <T, Size>(std::ostream &os, Lariat<T, Size> const &list);
 
+  // Batch Methods
+
+  /**
+   * @brief Applies a batch of operations in order, the same as calling the operations one by one. Positional
+   * operations start walking from the node of the previous one (or the closer end), so batches with nearby or
+   * ordered positions traverse the list once. Index and Find only look up, their results are not kept.
+   *
+   * @param batch Tuples of action, position and value, positions and values are ignored where not used
+   */
+  template<typename Action, typename Position, typename Value>
+  void apply(const std::vector<std::tuple<Action, Position, Value>> &batch);
+
+  // Cursor Methods
+
+  class Cursor;
+
+  /**
+   * @brief Creates a cursor on the element at index for repeated edits around one position, see Cursor. The element is
+   * found from the closer end of the Lariat.
+   *
+   * @param index Index of the element, size() for the end
+   * @return A cursor on the element
+   */
+  Cursor cursor(size_type index);
+
+  // Text Methods (Lariat<char, N> only)
+  // NOTE: insert and find take part in overload resolution only for char, a Lariat<std::string, N> keeps
+  // insert(index, "abc") and find("abc") for its own elements
+
+  /**
+   * @brief Inserts a string before the element at index. The elements of the node after index are set aside and
+   * appended again after the text, the text fills the node and new full nodes, all with one copy per node.
+   *
+   * @param index Location to insert, size() appends
+   * @param text Characters to insert
+   */
+  template<typename C = T, typename std::enable_if<std::is_same<C, char>::value, int>::type = 0>
+  void insert(size_type index, std::string_view text);
+
+  /**
+   * @brief Copies up to count characters starting at index into a string, with one copy per node.
+   *
+   * @param index Index of the first character, throws E_BAD_INDEX if it is past size()
+   * @param count Maximum number of characters
+   * @return The characters
+   */
+  std::string substr(size_type index, size_type count) const;
+
+  /**
+   * @brief Finds a string, including matches that span several nodes. Every node is searched with
+   * std::string_view::find, the characters around the boundaries of the nodes are searched separately.
+   *
+   * @param text The string to find
+   * @param from Index to start at
+   * @return Index of the first character of the first match at or after from, size() if not found
+   */
+  template<typename C = T, typename std::enable_if<std::is_same<C, char>::value, int>::type = 0>
+  size_type find(std::string_view text, size_type from = 0) const;
+
+  /**
+   * @brief Keeps the number of newlines of every node, so that line lookups only count the nodes accessed since the
+   * previous lookup. Without it every lookup counts the newlines of all the nodes it passes.
+   *
+   * @param on Whether to keep the counts
+   */
+  void track_lines(bool on);
+
+  /**
+   * @brief Number of lines, the number of newlines plus one
+   */
+  size_type line_count() const;
+
+  /**
+   * @brief Index of the first character of a line, throws E_BAD_INDEX if there are not that many lines
+   *
+   * @param line Line number, starting at 0
+   */
+  size_type line_start(size_type line) const;
+
+  /**
+   * @brief Line of the character at index, throws E_BAD_INDEX if index is past size()
+   *
+   * @param index Index of the character, size() for the end
+   */
+  size_type line_of(size_type index) const;
+
+  // Parallel Methods
+
+  /**
+   * @brief Calls f on every element. Large lists are split into runs of nodes that are visited on several threads,
+   * so f has to be safe to call concurrently; within a run the elements are visited in order.
+   *
+   * @param f Function taking a T&
+   */
+  template<typename F>
+  void for_each(F f);
+
+  /**
+   * @brief Calls f on every element, see for_each.
+   *
+   * @param f Function taking a const T&
+   */
+  template<typename F>
+  void for_each(F f) const;
+
+  /**
+   * @brief Replaces every element with f(element), on several threads for large lists.
+   *
+   * @param f Function taking a const T& and returning the new value
+   */
+  template<typename F>
+  void transform_inplace(F f);
+
+  /**
+   * @brief Folds the elements with op, on several threads for large lists. Every run is folded on its own and the
+   * partial results are folded in order, so the result is the one of a sequential fold when op is associative.
+   *
+   * @param init Starting value
+   * @param op Binary operation
+   * @return init folded with every element
+   */
+  template<typename R, typename BinaryOp>
+  R reduce(R init, BinaryOp op) const;
+
+  /**
+   * @brief Folds transform(element) for every element with reduce, on several threads for large lists, see reduce.
+   *
+   * @param init Starting value
+   * @param reduce Binary operation
+   * @param transform Function taking a const T&
+   * @return init folded with every transformed element
+   */
+  template<typename R, typename BinaryOp, typename UnaryOp>
+  R transform_reduce(R init, BinaryOp reduce, UnaryOp transform) const;
+
+  // Sorting Methods
+
+  /**
+   * @brief Sorts the elements in ascending order. Every node is sorted on its own (on several threads for large lists),
+   * then the sorted nodes are merged pairwise into full nodes, reusing the nodes that have been read.
+   */
+  void sort();
+
+  /**
+   * @brief Sorts the elements with comp, see sort(). comp must not throw.
+   *
+   * @param comp Strict weak ordering of two const T&
+   */
+  template<typename Compare>
+  void sort(Compare comp);
+
+  /**
+   * @brief Sorts the elements in ascending order, keeping the order of equal elements.
+   */
+  void stable_sort();
+
+  /**
+   * @brief Sorts the elements with comp keeping the order of equal elements, see sort(). comp must not throw.
+   *
+   * @param comp Strict weak ordering of two const T&
+   */
+  template<typename Compare>
+  void stable_sort(Compare comp);
+
+  /**
+   * @brief Writes the Lariat node by node through a buffer, the stream is not flushed.
+   *
+   * @param os Stream to write to
+   * @param format Layout of the output
+   */
+  void print(std::ostream &os, LariatFormat format) const;
+
+  // Serialization Methods
+
+  /**
+   * @brief Writes the Lariat in the versioned binary format (header followed by the packed values of every node).
+   *
+   * @param os Binary stream to write to
+   */
+  void save(std::ostream &os) const;
+
+  /**
+   * @brief Replaces the contents of the Lariat with the ones stored in the binary format. Nodes are filled completely.
+   *
+   * @param is Binary stream to read from
+   */
+  void load(std::istream &is);
+
+  /**
+   * @brief Appends the numbers of a text stream, the same as reading them with >> and calling push_back, for arithmetic
+   * T other than bool and the character types, which >> reads as characters. The stream is read in large blocks,
+   * numbers are parsed with std::from_chars straight into the nodes, which are filled completely. Numbers are separated
+   * by the delimiter or whitespace, empty fields are skipped. Throws E_DATA_ERROR for text that is not a number of type
+   * T, the numbers before it stay appended. A negative number for unsigned T throws E_DATA_ERROR as well, where >>
+   * wraps it around ("-1" gives the largest value).
+   *
+   * @param is Text stream to read to the end
+   * @param delimiter Character between the numbers besides whitespace
+   * @return Number of values appended
+   */
+  size_type read_from(std::istream &is, char delimiter = '\n');
+
+  /**
+   * @brief Appends the numbers read from a file descriptor until end of file, see read_from(std::istream &, char).
+   *
+   * @param fd File descriptor to read to the end
+   * @param delimiter Character between the numbers besides whitespace
+   * @return Number of values appended
+   */
+  size_type read_from(int fd, char delimiter = '\n');
+
   // Miscelaneous Methods
 
   /**
@@ -182,7 +696,7 @@ public:
    *
    * @return The amount of elements contained in the data structure
    */
-  size_t size(void) const; // total number of items (not nodes)
+  size_type size(void) const; // total number of items (not nodes)
 
   /**
    * @brief Clear the Lariat
@@ -194,21 +708,142 @@ public:
    */
   void compact(); // push data in front reusing empty positions and delete remaining nodes
 
+  /**
+   * @brief Does a bounded part of compact(): fills nodes with the first elements of the next node and releases the
+   * nodes that become empty. Every call continues where the previous one stopped.
+   *
+   * @param budget Maximum number of nodes visited plus elements moved
+   * @return Whether the end of the Lariat was reached, the next call starts again from the head
+   */
+  bool compact_step(size_type budget);
+
+  /**
+   * @brief Compacts automatically after every insertion or removal that leaves the Lariat with fewer elements than
+   * min_occupancy of its capacity, a bounded compact_step at a time.
+   *
+   * @param min_occupancy Ratio of elements to capacity to keep (0 turns automatic compaction off)
+   * @param budget Work allowed per operation, see compact_step
+   */
+  void auto_compact(double min_occupancy, size_type budget);
+
+  /**
+   * @brief Makes sure that at least n elements fit in the nodes of the Lariat and its spare nodes. The missing nodes are
+   * allocated right away and kept as spare nodes until insertions need them.
+   *
+   * @param n Number of elements to make room for
+   */
+  void reserve(size_type n);
+
+  /**
+   * @brief Compacts the Lariat and releases the spare nodes
+   */
+  void shrink_to_fit();
+
+  /**
+   * @brief Number of elements that fit in the nodes of the Lariat and its spare nodes
+   */
+  size_type capacity() const;
+
+  /**
+   * @brief Number of nodes holding the elements (spare nodes are not included)
+   */
+  size_type node_count() const;
+
+  /**
+   * @brief Sets how full nodes are split, only affects elements added afterwards
+   *
+   * @param policy The split policy to use
+   */
+  void split_policy(LariatSplit policy);
+
+  /**
+   * @brief Moves the nodes into a memory mapped backing file. Only the most recently used nodes stay in memory, the
+   * rest are written back to the file and faulted back in when accessed.
+   *
+   * @param path Location of the backing file
+   * @param resident_limit Amount of bytes of nodes that are allowed to stay in memory
+   */
+  void spill_to(const char *path, size_t resident_limit);
+
+  /**
+   * @brief Amount of bytes of nodes kept in memory while spilling (0 if the Lariat is not spilling)
+   */
+  size_t spill_resident_bytes() const;
+
+  /**
+   * @brief Packs the values of the nodes that have not been used recently, for integral T. A packed node stores its
+   * values relative to their minimum (or as deltas, whichever is smaller) with as few bits as they need, and gives
+   * the whole memory pages inside its values back to the system; it is unpacked the next time it is accessed. Only
+   * nodes spanning several pages save memory. References to elements stay valid until 4 other nodes are accessed.
+   *
+   * @param hot_nodes Number of most recently used nodes left unpacked (at least 4), 0 unpacks everything and stops
+   */
+  void compress_cold(size_type hot_nodes);
+
+  /**
+   * @brief Retrieves the counters collected so far along with the current occupancy of the nodes
+   */
+  LariatStats stats() const;
+
+  /**
+   * @brief Sets all the counters back to 0
+   */
+  void reset_stats();
+
 private:
   struct LNode { // DO NOT modify provided code
     LNode *next{nullptr};
     LNode *prev{nullptr};
     int count{0}; // number of items currently in the node
+    int start{0}; // slot of the first item, items wrap around the end of values
     T values[Size]{};
+
+    // item at position i of the node
+    T &value(int i) { return values[start + i < Size ? start + i : start + i - Size]; }
+    const T &value(int i) const { return values[start + i < Size ? start + i : start + i - Size]; }
   };
 
   // DO NOT modify provided code
   LNode *head_; // points to the first node
   LNode *tail_; // points to the last node
-  int size_; // the number of items (not nodes) in the list
-  mutable int nodecount_; // the number of nodes in the list
+  size_type size_; // the number of items (not nodes) in the list
+  mutable size_type nodecount_; // the number of nodes in the list
   int asize_; // the size of the array within the nodes
 
+  LariatSpillFile *spill_; // backing file of the nodes, nullptr when nodes live on the heap
+#ifndef LARIAT_NO_STATS
+  mutable LariatStats stats_; // counters, occupancy is only filled in by stats()
+#endif
+  LariatSplit split_; // what push_back and push_front do with a full node
+
+  // NOTE: Storage for one node inside the Lariat, small lists never allocate
+  static constexpr bool inline_node_ = sizeof(LNode) <= LARIAT_INLINE_NODE_BYTES;
+  alignas(LNode) mutable unsigned char inline_storage_[inline_node_ ? sizeof(LNode) : 1];
+  mutable bool inline_used_; // whether a node lives in inline_storage_
+
+  mutable LNode *spare_; // nodes allocated by reserve() and not used yet, linked through next
+  mutable size_type spare_count_;
+
+  mutable LNode *compact_from_; // where the next compact_step starts, nullptr for the head
+  double compact_ratio_; // automatic compaction below this ratio of elements to capacity, 0 when off
+  size_type compact_budget_; // work of one automatic compact_step
+
+  // NOTE: Bookkeeping of compress_cold(), the most recently used nodes are at the front of hot
+  struct ColdNodes {
+    size_type hot_limit{0};
+    const LNode *last{nullptr}; // skips the bookkeeping for repeated accesses to the same node
+    std::list<const LNode *> hot;
+    std::unordered_map<const LNode *, typename std::list<const LNode *>::iterator> hot_index;
+    std::unordered_map<const LNode *, std::vector<std::uint64_t>> packed;
+    std::vector<std::uint64_t> scratch; // values of the node being packed
+    std::size_t packed_bytes{0};
+    std::size_t unpacked_bytes{0};
+  };
+  mutable ColdNodes *cold_; // nullptr when compress_cold is off
+
+  // NOTE: Newlines of the nodes that have not been accessed since they were counted, nullptr when track_lines is off
+  std::unordered_map<const LNode *, size_type> *lines_;
+
   // Helper Struct
 
   struct ElementSearch {
@@ -216,6 +851,21 @@ private:
     int index{0};
   };
 
+  // NOTE: Where apply() left off, base is the index of the first element of node
+  struct BatchCursor {
+    LNode *node{nullptr};
+    size_type base{0};
+  };
+
+  // NOTE: Layout of the header written by save(), values are stored in native byte order
+  struct BinaryHeader {
+    char magic[4]{'L', 'R', 'A', 'T'};
+    std::uint32_t version{1};
+    std::uint32_t value_size{sizeof(T)};
+    std::uint32_t node_size{Size};
+    std::uint64_t count{0};
+  };
+
   // Helper Functions
 
   /**
@@ -227,15 +877,107 @@ private:
   LNode *split(LNode &to_split);
 
   /**
-   * @brief Finds the element at the given index
+   * @brief Links a new empty node before or after the given node.
+   *
+   * @param node The node to link next to, nullptr for an empty Lariat
+   * @param after Whether the new node goes after node
+   * @return Pointer to the new node
+   */
+  LNode *link_node(LNode *node, bool after);
+
+  /**
+   * @brief The operations of apply(), automatic compaction is suspended by the caller
+   *
+   * @param batch Tuples of action, position and value
+   */
+  template<typename Action, typename Position, typename Value>
+  void apply_batch(const std::vector<std::tuple<Action, Position, Value>> &batch);
+
+  /**
+   * @brief Runs a compact_step when automatic compaction is on and the occupancy is below the threshold.
+   *
+   * @return Whether a compact_step ran
+   */
+  bool auto_compact_step();
+
+  /**
+   * @brief Inserts a value at a position found by find_element, before the element at that position.
+   *
+   * @param search The position to insert at
+   * @param value Value to insert
+   */
+  void insert_at(ElementSearch search, const T &value);
+
+  /**
+   * @brief Erases the element at a position found by find_element, the node must not be the head or the tail when it
+   * becomes empty.
+   *
+   * @param search The position of the element to erase
+   */
+  void erase_at(ElementSearch search);
+
+  /**
+   * @brief Erase the first element of a non-empty Lariat
+   */
+  void remove_front();
+
+  /**
+   * @brief Moves the elements to keep towards the front with a write position that trails the read position, then
+   * releases the nodes after the last written one.
    *
+   * @param remove Function taking the element and the last kept element (nullptr before the first one)
+   * @return Number of erased elements
+   */
+  template<typename Remove>
+  size_type remove_matching(Remove remove);
+
+  /**
+   * @brief Erase the last element of a non-empty Lariat
+   */
+  void remove_back();
+
+  /**
+   * @brief Finds the element at the given index starting from the cursor or from the closer end of the Lariat, and
+   * moves the cursor to the node of the element. The caller checks that the index is in range.
+   *
+   * @param cursor Node and index of its first element where the previous search ended
    * @param index The index to look in
    * @return A struct containing the results of the search.
    */
-  ElementSearch find_element(int index) const;
+  ElementSearch seek(BatchCursor &cursor, size_type index) const;
 
   /**
-   * @brief Shifts all elements in the node up by 1 index.
+   * @brief push_front that keeps the cursor of apply() valid
+   *
+   * @param cursor The cursor to update
+   * @param value Value to insert
+   */
+  void push_front_at(BatchCursor &cursor, const T &value);
+
+  /**
+   * @brief pop_front of a non-empty Lariat that keeps the cursor of apply() valid
+   *
+   * @param cursor The cursor to update
+   */
+  void pop_front_at(BatchCursor &cursor);
+
+  /**
+   * @brief pop_back of a non-empty Lariat that keeps the cursor of apply() valid
+   *
+   * @param cursor The cursor to update
+   */
+  void pop_back_at(BatchCursor &cursor);
+
+  /**
+   * @brief Finds the element at the given index, the caller checks that the index is in range
+   *
+   * @param index The index to look in
+   * @return A struct containing the results of the search.
+   */
+  ElementSearch find_element(size_type index) const;
+
+  /**
+   * @brief Opens a gap at index by moving the elements after it up or the ones before it down, whichever is shorter.
    *
    * @param node The node to shift up in.
    * @param index The index to shift up from.
@@ -243,7 +985,7 @@ private:
   void shift_up(LNode *node, int index);
 
   /**
-   * @brief Shifts all elements in the node down by 1 index.
+   * @brief Closes the gap at index by moving the elements after it down or the ones before it up, whichever is shorter.
    *
    * @param node The node to shift down in.
    * @param index The index to shift down from.
@@ -251,9 +993,244 @@ private:
   void shift_down(LNode *node, int index);
 
   /**
-   * @brief Factory method for a node. This will throw an exception if it fails.
+   * @brief The parsing of read_from, blocks of text come from read.
+   *
+   * @param read Function taking a char* and a std::size_t capacity, returns the number of bytes read (0 at the end)
+   * @param delimiter Character between the numbers besides whitespace
+   * @return Number of values appended
+   */
+  template<typename Read>
+  size_type read_text(Read read, char delimiter);
+
+  /**
+   * @brief Copies count elements of a node starting at position from, with one copy per contiguous piece of the ring.
+   *
+   * @param node The node to read
+   * @param from Position of the first element in the node
+   * @param count Number of elements, from + count must not be past the count of the node
+   * @param output Where the elements go
+   */
+  void read_run(const LNode *node, int from, int count, T *output) const;
+
+  /**
+   * @brief Copies elements into a node at position at, with one copy per contiguous piece of the ring. The count of
+   * the node is not changed.
+   *
+   * @param node The node to write
+   * @param at Position of the first element in the node, at + count must not be past Size
+   * @param input The elements
+   * @param count Number of elements
+   */
+  void write_run(LNode *node, int at, const T *input, int count);
+
+  /**
+   * @brief Appends elements after the ones of node, filling it and then new nodes linked after it. The size is not
+   * changed.
+   *
+   * @param node The node to append to, nullptr for an empty Lariat
+   * @param input The elements
+   * @param count Number of elements
+   * @return The last node written (node if count is 0)
+   */
+  LNode *append_run(LNode *node, const T *input, size_type count);
+
+  /**
+   * @brief Copies count elements starting at index, the caller checks the range.
+   *
+   * @param index Index of the first element
+   * @param count Number of elements
+   * @param output Where the elements go
+   */
+  void copy_range(size_type index, size_type count, T *output) const;
+
+  /**
+   * @brief Number of newlines in a node, kept in lines_ when track_lines is on
+   *
+   * @param node The node to count in
+   */
+  size_type newlines(const LNode *node) const;
+
+  /**
+   * @brief Factory method for a node, spare nodes left by reserve() are used first. This will throw an exception if it
+   * fails.
    */
   LNode *create_node() const;
+
+  /**
+   * @brief Allocates a new node from the backing file, the inline storage or the heap. This will throw an exception if
+   * it fails.
+   */
+  LNode *allocate_node() const;
+
+  /**
+   * @brief Releases the spare nodes left by reserve()
+   */
+  void release_spares();
+
+  /**
+   * @brief Fills an empty Lariat with the converted elements of other. The nodes get the same counts push_back would
+   * give them, whole runs of elements are converted at once and large lists are converted in parallel.
+   *
+   * @param other The Lariat to copy
+   */
+  template<typename OtherT, int OtherSize>
+  void copy_from(const Lariat<OtherT, OtherSize> &other);
+
+  /**
+   * @brief Converts the elements of other starting at the given position into a new node, and moves the position past
+   * them.
+   *
+   * @param node The node to fill, count is already set
+   * @param other The Lariat being copied
+   * @param source Node of other holding the next element
+   * @param offset Position of the next element in source
+   */
+  template<typename OtherT, int OtherSize>
+  void convert_node(LNode *node, const Lariat<OtherT, OtherSize> &other,
+                    const typename Lariat<OtherT, OtherSize>::LNode *&source, int &offset) const;
+
+  /**
+   * @brief Splits the nodes into runs holding about the same number of elements, one run per thread.
+   *
+   * @param elements Number of elements the work is about, picks the number of runs
+   * @return First node of every run followed by nullptr
+   */
+  std::vector<LNode *> runs(size_type elements) const;
+
+  /**
+   * @brief Calls f on every element of the nodes from first up to (not including) last, in order.
+   *
+   * @param first First node to visit
+   * @param last Node to stop at, nullptr for the end
+   * @param skip Number of elements of first to leave out
+   * @param f Function taking a T&
+   */
+  template<typename F>
+  void visit(LNode *first, LNode *last, int skip, F &f) const;
+
+  /**
+   * @brief Sorts every node, then merges the nodes pairwise until one sorted run is left.
+   *
+   * @param comp Strict weak ordering of two const T&
+   * @param stable Whether equal elements keep their order
+   */
+  template<typename Compare>
+  void sort_nodes(Compare &comp, bool stable);
+
+  /**
+   * @brief Merges two sorted runs of nodes (linked by next only) into one. Output nodes are taken from pool and the
+   * input nodes that have been read go back to it, pool has to hold 2 nodes for a merge to never run out.
+   *
+   * @param a First run, wins ties
+   * @param b Second run
+   * @param comp Strict weak ordering of two const T&
+   * @param pool Unused nodes
+   * @return First node of the merged run
+   */
+  template<typename Compare>
+  LNode *merge_runs(LNode *a, LNode *b, Compare &comp, std::vector<LNode *> &pool) const;
+
+  /**
+   * @brief Releases a node created by create_node.
+   *
+   * @param node The node to release
+   */
+  void destroy_node(LNode *node) const;
+
+  /**
+   * @brief Marks the node as recently used so the backing file keeps it in memory.
+   *
+   * @param node The node that is being accessed
+   */
+  void touch(const LNode *node) const;
+
+  /**
+   * @brief Moves the node to the front of the nodes left unpacked, unpacking it if needed and packing the least
+   * recently used one when there are too many.
+   *
+   * @param node The node that is being accessed
+   */
+  void touch_cold(const LNode *node) const;
+
+  /**
+   * @brief Packs the values of the node and releases the memory pages inside its values, unless that saves nothing.
+   *
+   * @param node The node to pack
+   */
+  void pack_node(const LNode *node) const;
+
+  /**
+   * @brief Restores the values of a packed node and drops its packed copy.
+   *
+   * @param node The node to unpack
+   */
+  void unpack_node(const LNode *node) const;
+
+  /**
+   * @brief Drops everything compress_cold keeps about a node that is being released.
+   *
+   * @param node The node that is being released
+   */
+  void forget_cold(const LNode *node) const;
+};
+
+/**
+ * @brief Position in a Lariat that elements can be read, inserted and erased at without walking the list: the node,
+ * the position in the node and the index of the element. Edits through the cursor keep it valid across splits and
+ * released nodes and cost O(Size); any other change of the Lariat, including edits through another cursor, invalidates
+ * it. When an edit makes automatic compaction move elements, the cursor finds its index again.
+ */
+template<typename T, int Size>
+class Lariat<T, Size>::Cursor {
+public:
+  /**
+   * @brief Index of the element under the cursor, size() at the end
+   */
+  size_type index() const;
+
+  /**
+   * @brief Whether the cursor is past the last element
+   */
+  bool at_end() const;
+
+  /**
+   * @brief The element under the cursor, throws E_BAD_INDEX at the end
+   */
+  T &value();
+  const T &value() const;
+
+  /**
+   * @brief Moves the cursor by n elements (backwards when negative), throws E_BAD_INDEX if that leaves [0, size()]
+   */
+  void advance(std::ptrdiff_t n);
+
+  /**
+   * @brief Inserts a value before the element under the cursor, the cursor stays on that element. Repeated inserts
+   * add the values in order, like typing.
+   */
+  void insert_here(const T &value);
+
+  /**
+   * @brief Erases the element under the cursor and moves the cursor to the element after it. Throws E_DATA_ERROR on
+   * an empty Lariat and E_BAD_INDEX at the end.
+   */
+  void erase_here();
+
+private:
+  friend class Lariat;
+
+  Cursor(Lariat *list, LNode *node, int offset, size_type index);
+
+  // NOTE: At the end node_ is the tail and offset_ its count, nullptr and 0 for an empty Lariat
+  Lariat *list_;
+  LNode *node_;
+  int offset_; // position of the element in node_
+  size_type index_;
+
+  /**
+   * @brief Runs the automatic compaction after an edit and finds the index again when it ran
+   */
+  void compact_step();
 };
 
 #ifndef LARIAT_CPP
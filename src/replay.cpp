@@ -0,0 +1,141 @@
+// Records seeded scenarios to trace files and replays them for timing
+// usage:
+//   lariat_replay record <trace> <seed> <num_operations> <insert> <erase> <pushback> <pushfront>
+//                        <popback> <popfront> <compact> <index> <find>
+//   lariat_replay run <trace> <node size> <repetitions>
+#include <algorithm>
+#include <chrono>
+#include <cstdio> /* sscanf */
+#include <cstring> /* strcmp */
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "scenario.h"
+
+// times "repetitions" runs of the scenario, every run starts from an empty container
+template<typename C, typename Play>
+void time_runs(char const *label, int repetitions, Play play_once) {
+  std::vector<double> samples;
+  for (int rep = 0; rep < repetitions; ++rep) {
+    C c;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    play_once(c);
+    std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - start;
+    samples.push_back(elapsed_seconds.count());
+  }
+
+  std::sort(samples.begin(), samples.end());
+  double mean = 0;
+  for (double sample: samples) mean += sample;
+  mean /= static_cast<double>(samples.size());
+
+  std::cout << label << ": min " << samples.front() << " median " << samples[samples.size() / 2] << " mean " << mean
+            << " max " << samples.back() << std::endl;
+}
+
+template<int nodesize>
+void replay(LariatScenario const &sc, int repetitions) {
+  std::cout << "Lariat<int, " << nodesize << ">, " << sc.Get().size() << " operations, " << repetitions
+            << " repetitions (seconds)" << std::endl;
+  time_runs<Lariat<int, nodesize>>("Lariat", repetitions, [&sc](Lariat<int, nodesize> &lar) { play(lar, sc); });
+  time_runs<std::vector<int>>("Vector", repetitions, [&sc](std::vector<int> &v) { play(v, sc); });
+}
+
+// node sizes that can be replayed, a node size has to be known at compile time
+bool replay_size(int nodesize, LariatScenario const &sc, int repetitions) {
+  switch (nodesize) {
+    case 1: replay<1>(sc, repetitions); break;
+    case 2: replay<2>(sc, repetitions); break;
+    case 5: replay<5>(sc, repetitions); break;
+    case 6: replay<6>(sc, repetitions); break;
+    case 10: replay<10>(sc, repetitions); break;
+    case 16: replay<16>(sc, repetitions); break;
+    case 32: replay<32>(sc, repetitions); break;
+    case 64: replay<64>(sc, repetitions); break;
+    case 100: replay<100>(sc, repetitions); break;
+    case 128: replay<128>(sc, repetitions); break;
+    case 256: replay<256>(sc, repetitions); break;
+    case 500: replay<500>(sc, repetitions); break;
+    case 512: replay<512>(sc, repetitions); break;
+    case 1000: replay<1000>(sc, repetitions); break;
+    case 1024: replay<1024>(sc, repetitions); break;
+    case 5000: replay<5000>(sc, repetitions); break;
+    default: return false;
+  }
+  return true;
+}
+
+int record(int argc, char *argv[]) {
+  if (argc != 14) {
+    std::cerr << "record needs a trace, a seed, the number of operations and 9 frequencies\n";
+    return 1;
+  }
+
+  unsigned seed = 0;
+  int num_operations = 0;
+  float f[9]{};
+  std::sscanf(argv[3], "%u", &seed);
+  std::sscanf(argv[4], "%i", &num_operations);
+  for (int i = 0; i < 9; ++i) {
+    std::sscanf(argv[5 + i], "%f", &f[i]);
+  }
+
+  // same value range as the timing scenario of the driver (test25)
+  LariatScenario sc(num_operations, 200000, f[0], f[1], f[2], f[3], f[4], f[5], f[6], f[7], f[8], seed);
+  std::ofstream trace(argv[2]);
+  trace << sc;
+  if (!trace) {
+    std::cerr << "cannot write " << argv[2] << std::endl;
+    return 1;
+  }
+
+  std::cout << "Recorded " << sc.Get().size() << " operations with seed " << seed << " to " << argv[2] << std::endl;
+  return 0;
+}
+
+int run(int argc, char *argv[]) {
+  if (argc != 5) {
+    std::cerr << "run needs a trace, a node size and a repetition count\n";
+    return 1;
+  }
+
+  std::ifstream trace(argv[2]);
+  if (!trace) {
+    std::cerr << "cannot read " << argv[2] << std::endl;
+    return 1;
+  }
+  LariatScenario sc(trace);
+
+  int nodesize = 0, repetitions = 1;
+  std::sscanf(argv[3], "%i", &nodesize);
+  std::sscanf(argv[4], "%i", &repetitions);
+  if (repetitions < 1) {
+    repetitions = 1;
+  }
+
+  try {
+    if (!replay_size(nodesize, sc, repetitions)) {
+      std::cerr << "node size " << nodesize << " is not compiled in\n";
+      return 1;
+    }
+  } catch (LariatException &le) {
+    std::cerr << "Somethingbad happened: " << le.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc > 1 && std::strcmp(argv[1], "record") == 0) {
+    return record(argc, argv);
+  }
+  if (argc > 1 && std::strcmp(argv[1], "run") == 0) {
+    return run(argc, argv);
+  }
+
+  std::cerr << "usage: " << argv[0]
+            << " record <trace> <seed> <num_operations> <insert> <erase> <pushback> <pushfront> <popback> <popfront>"
+               " <compact> <index> <find>\n"
+            << "       " << argv[0] << " run <trace> <node size> <repetitions>\n";
+  return 1;
+}
@@ -0,0 +1,365 @@
+// Random scenarios of Lariat operations, used by the driver and the trace runners
+// a scenario generated with a given seed is always the same, scenarios can be recorded
+// with operator<< and replayed with operator>>
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <algorithm> // std::max_element std::find
+#include <functional> // std::bind std::placeholders
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "lariat.h"
+
+// same values as LariatAction, so a scenario can be passed to Lariat::apply
+enum Action {
+  Insert = static_cast<int>(LariatAction::Insert), // always OK
+  Pushback = static_cast<int>(LariatAction::Pushback),
+  Pushfront = static_cast<int>(LariatAction::Pushfront),
+  Compact = static_cast<int>(LariatAction::Compact),
+  Erase = static_cast<int>(LariatAction::Erase), // when non-empty
+  Popback = static_cast<int>(LariatAction::Popback),
+  Popfront = static_cast<int>(LariatAction::Popfront),
+  Index = static_cast<int>(LariatAction::Index),
+  Find = static_cast<int>(LariatAction::Find)
+};
+
+class RouletteWheel {
+public:
+  RouletteWheel() = delete;
+  RouletteWheel(RouletteWheel const &) = delete;
+  RouletteWheel(RouletteWheel &&) = delete;
+  RouletteWheel &operator=(RouletteWheel const &) = delete;
+  RouletteWheel &operator=(RouletteWheel &&) = delete;
+  ~RouletteWheel() = default;
+
+  RouletteWheel(
+      std::multimap<float, Action> const &_p, float _from, float _to, std::mt19937::result_type seed) :
+      p(_p), gen(seed), dis(_from, _to) {
+    for (auto const &el: p) {
+      // std::cout << el.first << " --> " << el.second << std::endl;
+      v.push_back(std::tuple<float, Action>(el.first, el.second));
+    }
+    // std::cout << "upper limit " << _to << std::endl;
+  }
+
+  Action Spin() {
+    return p.upper_bound(dis(gen))->second; // find key of the first element of the map that is >= rand_value
+  }
+
+private:
+  std::vector<std::tuple<float, Action>> v;
+  std::multimap<float, Action> const &p;
+  std::mt19937 gen;
+  std::uniform_real_distribution<float> dis;
+};
+
+class RandomNumber {
+public:
+  RandomNumber() = delete;
+  RandomNumber(RandomNumber const &) = delete;
+  RandomNumber(RandomNumber &&) = delete;
+  RandomNumber &operator=(RandomNumber const &) = delete;
+  RandomNumber &operator=(RandomNumber &&) = delete;
+  ~RandomNumber() = default;
+
+  RandomNumber(int _from, int _to, std::mt19937::result_type seed) : gen(seed), dis(_from, _to) {}
+
+  int GetInt(int max) {
+    int rand_value = dis(gen);
+    return rand_value % (max); // returns 0..max-1 inclusively
+  }
+
+private:
+  std::mt19937 gen;
+  std::uniform_int_distribution<> dis;
+};
+
+class LariatScenario {
+public:
+  LariatScenario() = delete;
+  LariatScenario(LariatScenario const &) = delete;
+  LariatScenario(LariatScenario &&) = delete;
+  LariatScenario &operator=(LariatScenario const &) = delete;
+  LariatScenario &operator=(LariatScenario &&) = delete;
+  ~LariatScenario() = default;
+  LariatScenario(
+      int num_operations,
+      int max_value,
+      float insertF,
+      float eraseF, // relative frequences of the 9 operations
+      float pushbackF,
+      float pushfrontF, // do not have to add up to 1
+      float popbackF,
+      float popfrontF, // normalized by hand
+      float compactF,
+      float indexF,
+      float findF,
+      std::mt19937::result_type seed = std::random_device{}()) { // same seed - same scenario
+    int current_size = 0; // need to know whether delete-like operations are allowed
+
+    std::multimap<float, Action> probabilities;
+    float TotalF = insertF + eraseF + pushbackF + pushfrontF + popbackF + popfrontF + compactF + indexF + findF;
+
+    //            probabilities[(insertF + pushbackF + pushfrontF + compactF + eraseF + popbackF + popfrontF + indexF +
+    //            findF) / TotalF ]    =  Find; probabilities[(insertF + pushbackF + pushfrontF + compactF + eraseF +
+    //            popbackF + popfrontF + indexF ) / TotalF        ]    =  Index; probabilities[(insertF + pushbackF +
+    //            pushfrontF + compactF + eraseF + popbackF + popfrontF) / TotalF                  ]    =  Popfront;
+    //            probabilities[(insertF + pushbackF + pushfrontF + compactF + eraseF + popbackF ) / TotalF ]    =
+    //            Popback; probabilities[(insertF + pushbackF + pushfrontF + compactF + eraseF) / TotalF ]    =  Erase;
+    //            probabilities[(insertF + pushbackF + pushfrontF + compactF) / TotalF ]    =  Compact;
+    //            probabilities[(insertF + pushbackF + pushfrontF) / TotalF ]    =  Pushfront; probabilities[(insertF +
+    //            pushbackF) / TotalF                                                                          ]    =
+    //            Pushback; probabilities[ insertF / TotalF ]    =  Insert;
+    // actions that never happen are left out, otherwise they share the key of the previous action
+    if (findF > 0) {
+      probabilities.insert(std::make_pair(
+          (insertF + pushbackF + pushfrontF + compactF + eraseF + popbackF + popfrontF + indexF + findF) / TotalF,
+          Find));
+    }
+    if (indexF > 0) {
+      probabilities.insert(std::make_pair(
+          (insertF + pushbackF + pushfrontF + compactF + eraseF + popbackF + popfrontF + indexF) / TotalF, Index));
+    }
+    if (popfrontF > 0) {
+      probabilities.insert(std::make_pair(
+          (insertF + pushbackF + pushfrontF + compactF + eraseF + popbackF + popfrontF) / TotalF, Popfront));
+    }
+    if (popbackF > 0) {
+      probabilities.insert(
+          std::make_pair((insertF + pushbackF + pushfrontF + compactF + eraseF + popbackF) / TotalF, Popback));
+    }
+    if (eraseF > 0) {
+      probabilities.insert(std::make_pair((insertF + pushbackF + pushfrontF + compactF + eraseF) / TotalF, Erase));
+    }
+    if (compactF > 0) {
+      probabilities.insert(std::make_pair((insertF + pushbackF + pushfrontF + compactF) / TotalF, Compact));
+    }
+    if (pushfrontF > 0) {
+      probabilities.insert(std::make_pair((insertF + pushbackF + pushfrontF) / TotalF, Pushfront));
+    }
+    if (pushbackF > 0) {
+      probabilities.insert(std::make_pair((insertF + pushbackF) / TotalF, Pushback));
+    }
+    if (insertF > 0) {
+      probabilities.insert(std::make_pair(insertF / TotalF, Insert));
+    }
+
+    RouletteWheel rw_all(probabilities, 0, 1, seed); // roulette wheel with required frequencies for all actions
+    float upper_limit_for_empty = (insertF + pushbackF + pushfrontF + compactF) / TotalF; // use instead of 1 if empty
+    RouletteWheel rw_insert(
+        probabilities,
+        0,
+        upper_limit_for_empty,
+        seed + 1); // roulette wheel with required frequencies for insert-like actions
+
+    // num_operations is more or less magic number in this context, squared it overflows past 46340 operations
+    long long range = static_cast<long long>(num_operations) * num_operations;
+    RandomNumber rn(0, static_cast<int>(std::min<long long>(range, std::numeric_limits<int>::max())), seed + 2);
+
+    for (int i = 0; i < num_operations; ++i) {
+      Action action;
+      if (current_size == 0) { // only insert, pushes, compact are allowed
+        action = rw_insert.Spin();
+      } else {
+        action = rw_all.Spin();
+      }
+
+      if (action == Insert) { // insert is legal at indicies 0..current_size inclusively
+        scenario.push_back(std::tuple<Action, int, int>(action, rn.GetInt(current_size + 1), rn.GetInt(max_value)));
+        ++current_size;
+      } else if (action == Erase) { // erase is legal at indicies 0..current_size-1 inclusively
+        scenario.push_back(
+            std::tuple<Action, int, int>(action, rn.GetInt(current_size), 0)); // value not used by operation
+        --current_size;
+      } else if (action == Pushfront || action == Pushback) {
+        scenario.push_back(std::tuple<Action, int, int>(action, 0, rn.GetInt(100))); // position not used by operation
+        ++current_size;
+      } else if (action == Popfront || action == Popback) {
+        scenario.push_back(std::tuple<Action, int, int>(action, 0, 0)); // position and value not used by operation
+        --current_size;
+      } else if (action == Compact) {
+        scenario.push_back(std::tuple<Action, int, int>(action, 0, 0)); // position and value not used by operation
+      } else if (action == Find) {
+        scenario.push_back(std::tuple<Action, int, int>(action, 0, rn.GetInt(100))); // value
+      } else if (action == Index) {
+        scenario.push_back(std::tuple<Action, int, int>(action, rn.GetInt(current_size), 0)); // position
+      } else {
+        std::cout << "illegal operation\n";
+      }
+    }
+  }
+
+  // replay a scenario recorded with operator<<
+  explicit LariatScenario(std::istream &is) { is >> *this; }
+
+  friend std::ostream &operator<<(std::ostream &os, LariatScenario const &sc) {
+    for (auto const &op: sc.Get()) {
+      int val = std::get<2>(op);
+      int pos = std::get<1>(op);
+      Action a = std::get<0>(op);
+      switch (a) { // use labels
+        case Insert: os << "Insert"; break;
+        case Erase: os << "Erase"; break;
+        case Pushback: os << "Pushback"; break;
+        case Pushfront: os << "Pushfront"; break;
+        case Popfront: os << "Popfront"; break;
+        case Popback: os << "Popback"; break;
+        case Compact: os << "Compact"; break;
+        case Index: os << "Index"; break;
+        case Find: os << "Find"; break;
+      }
+      os << " " << pos << " " << val << '\n';
+    }
+    return os;
+  }
+
+  friend std::istream &operator>>(std::istream &is, LariatScenario &sc) {
+    sc.scenario.erase(sc.scenario.begin(), sc.scenario.end());
+    for (std::string a_str; is >> a_str;) {
+      int pos = 0, val = 0;
+      Action a;
+      if (a_str == "Insert") {
+        a = Insert;
+        is >> pos >> val;
+      } else if (a_str == "Erase") {
+        a = Erase;
+        is >> pos;
+      } else if (a_str == "Pushback") {
+        a = Pushback;
+        is >> val;
+      } else if (a_str == "Pushfront") {
+        a = Pushfront;
+        is >> val;
+      } else if (a_str == "Popfront") {
+        a = Popfront;
+      } else if (a_str == "Popback") {
+        a = Popback;
+      } else if (a_str == "Compact") {
+        a = Compact;
+      } else if (a_str == "Index") {
+        a = Index;
+        is >> pos;
+      } else if (a_str == "Find") {
+        a = Find;
+        is >> val;
+      } else {
+        continue; // unknown action - skip it
+      }
+      sc.scenario.push_back(std::tuple<Action, int, int>(a, pos, val));
+    }
+    return is;
+  }
+
+  ////////////////////////////////////////////////////
+  std::vector<std::tuple<Action, int, int>> const &Get() const { return scenario; }
+
+  void
+  DrawStats(std::map<Action, std::string> &labels) const // reference should be const, but std::map[] is complaining
+  {
+    // final frequencies
+    std::map<Action, float> counts;
+    for (auto const &op: scenario) {
+      Action a = std::get<0>(op);
+      counts[a] += 1.0f;
+    }
+
+    // normalization - longest label
+    unsigned max_len = 0;
+    for (auto const &lbl: labels) {
+      if (lbl.second.length() > max_len) {
+        max_len = static_cast<unsigned>(lbl.second.length());
+      }
+    }
+
+    // normalization 80 symbols
+    float max_freq = std::max_element(
+                         counts.begin(),
+                         counts.end(),
+                         std::bind(
+                             std::less<float>(),
+                             bind(&std::map<Action, float>::value_type::second, std::placeholders::_1),
+                             bind(&std::map<Action, float>::value_type::second, std::placeholders::_2)))
+                         ->second;
+
+    max_len += 1; // bar offset
+    // print
+    std::cout << "Statistics\n";
+    for (auto const &el: counts) {
+      std::cout << std::left << std::setw(static_cast<int>(max_len)) << labels[el.first] << std::setfill('+')
+                << std::setw(static_cast<int>(el.second / max_freq * static_cast<float>(79 - max_len))) << "+"
+                << std::setfill(' ') << std::endl; // should have saved fill from before and set it back, assume 'space'
+    }
+  }
+
+private:
+  std::vector<std::tuple<Action, int, int>> scenario; // action, position, value
+};
+
+// apply every operation of the scenario, results of Index and Find are discarded
+template<int nodesize>
+void play(Lariat<int, nodesize> &lar, LariatScenario const &sc) {
+  for (auto const &op: sc.Get()) {
+    int val = std::get<2>(op);
+    int pos = std::get<1>(op);
+    Action a = std::get<0>(op);
+    switch (a) {
+      case Insert: lar.insert(pos, val); break;
+      case Erase: lar.erase(pos); break;
+      case Pushback: lar.push_back(val); break;
+      case Pushfront: lar.push_front(val); break;
+      case Popfront: lar.pop_front(); break;
+      case Popback: lar.pop_back(); break;
+      case Compact: lar.compact(); break;
+      case Index: lar.at(pos); break;
+      case Find: lar.find(val); break;
+    }
+  }
+}
+
+// same as play with the unchecked operations, every position of a scenario is valid
+template<int nodesize>
+void play_unchecked(Lariat<int, nodesize> &lar, LariatScenario const &sc) {
+  for (auto const &op: sc.Get()) {
+    int val = std::get<2>(op);
+    int pos = std::get<1>(op);
+    Action a = std::get<0>(op);
+    switch (a) {
+      case Insert: lar.insert_unchecked(pos, val); break;
+      case Erase: lar.erase_unchecked(pos); break;
+      case Pushback: lar.push_back(val); break;
+      case Pushfront: lar.push_front(val); break;
+      case Popfront: lar.pop_front(); break;
+      case Popback: lar.pop_back(); break;
+      case Compact: lar.compact(); break;
+      case Index: lar[pos]; break;
+      case Find: lar.find(val); break;
+    }
+  }
+}
+
+inline void play(std::vector<int> &v, LariatScenario const &sc) {
+  for (auto const &op: sc.Get()) {
+    int val = std::get<2>(op);
+    int pos = std::get<1>(op);
+    Action a = std::get<0>(op);
+    switch (a) {
+      case Insert: v.insert(v.begin() + pos, val); break;
+      case Erase: v.erase(v.begin() + pos); break;
+      case Pushback: v.push_back(val); break;
+      case Pushfront: v.insert(v.begin(), val); break;
+      case Popfront: v.erase(v.begin()); break;
+      case Popback: v.pop_back(); break;
+      case Compact: std::vector<int>(v).swap(v); break;
+      case Index: v[static_cast<size_t>(pos)]; break;
+      case Find: std::find(v.begin(), v.end(), val); break;
+    }
+  }
+}
+
+#endif // SCENARIO_H
@@ -0,0 +1,237 @@
+// Parallel stress testing of Lariat against std::vector
+// runs seeded scenarios for every combination of node size and operation mix on all cores
+// usage: lariat_stress [total_operations] [operations_per_scenario] [threads] [seed]
+#include <atomic>
+#include <chrono>
+#include <cstdio> /* sscanf */
+#include <cstring> /* memcmp */
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "scenario.h"
+
+struct Mix {
+  char const *name;
+  float f[9]; // insert, erase, pushback, pushfront, popback, popfront, compact, index, find
+};
+
+const Mix mixes[] = {
+    {"balanced", {2, 1, 1, 1, 1, 1, 1, 1, 1}}, // test25
+    {"growing", {4, 1, 4, 2, 1, 1, 1, 1, 1}}, // test24
+    {"queue", {0, 0, 4, 0, 0, 4, 0, 1, 0}},
+    {"stack", {0, 0, 4, 0, 4, 0, 0, 1, 0}},
+    {"middle", {4, 4, 1, 1, 0, 0, 1, 2, 1}},
+};
+const int num_mixes = sizeof(mixes) / sizeof(mixes[0]);
+
+struct Outcome {
+  bool ok{true};
+  std::string error;
+  double seconds{0};
+};
+
+// the whole content of the Lariat, in order, through the binary format
+template<int nodesize>
+bool same_content(Lariat<int, nodesize> const &lar, std::vector<int> const &v) {
+  if (lar.size() != v.size()) {
+    return false;
+  }
+
+  std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+  lar.save(ss);
+  std::string bytes = ss.str();
+  size_t header = bytes.size() - v.size() * sizeof(int);
+  return v.empty() || std::memcmp(bytes.data() + header, v.data(), v.size() * sizeof(int)) == 0;
+}
+
+// applies every operation to both containers, compares results of Index/Find after every operation
+// and the whole content 16 times per scenario, then applies the scenario again as one batch
+template<int nodesize>
+Outcome check(LariatScenario const &sc) {
+  Outcome outcome;
+  Lariat<int, nodesize> lar;
+  std::vector<int> v;
+
+  const size_t full_check = sc.Get().size() / 16 + 1;
+  size_t step = 0;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  try {
+    for (auto const &op: sc.Get()) {
+      int val = std::get<2>(op);
+      int pos = std::get<1>(op);
+      Action a = std::get<0>(op);
+      switch (a) {
+        case Insert:
+          lar.insert(pos, val);
+          v.insert(v.begin() + pos, val);
+          break;
+        case Erase:
+          lar.erase(pos);
+          v.erase(v.begin() + pos);
+          break;
+        case Pushback:
+          lar.push_back(val);
+          v.push_back(val);
+          break;
+        case Pushfront:
+          lar.push_front(val);
+          v.insert(v.begin(), val);
+          break;
+        case Popfront:
+          lar.pop_front();
+          v.erase(v.begin());
+          break;
+        case Popback:
+          lar.pop_back();
+          v.pop_back();
+          break;
+        case Compact:
+          lar.compact();
+          std::vector<int>(v).swap(v);
+          break;
+        case Index:
+          if (lar.at(pos) != v[static_cast<size_t>(pos)]) {
+            outcome.error = "Index failed at pos " + std::to_string(pos);
+          }
+          break;
+        case Find: {
+          size_t expected = static_cast<size_t>(std::find(v.begin(), v.end(), val) - v.begin());
+          if (lar.find(val) != expected) {
+            outcome.error = "Find failed for value " + std::to_string(val);
+          }
+          break;
+        }
+      }
+
+      ++step;
+      if (outcome.error.empty() && lar.size() != v.size()) {
+        outcome.error = "sizes differ after operation " + std::to_string(step);
+      }
+      if (outcome.error.empty() && (step % full_check == 0 || step == sc.Get().size()) && !same_content(lar, v)) {
+        outcome.error = "values differ after operation " + std::to_string(step);
+      }
+      if (!outcome.error.empty()) {
+        break;
+      }
+    }
+
+    // the whole scenario as one batch ends with the same content
+    if (outcome.error.empty()) {
+      Lariat<int, nodesize> batched;
+      batched.apply(sc.Get());
+      if (!same_content(batched, v)) {
+        outcome.error = "apply differs from sequential operations";
+      }
+    }
+  } catch (LariatException &le) {
+    outcome.error = std::string("exception after operation ") + std::to_string(step) + ": " + le.what();
+  }
+  std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - start;
+
+  outcome.ok = outcome.error.empty();
+  outcome.seconds = elapsed_seconds.count();
+  return outcome;
+}
+
+const int sizes[] = {1, 2, 5, 64, 5000};
+Outcome (*const checkers[])(LariatScenario const &) = {check<1>, check<2>, check<5>, check<64>, check<5000>};
+const int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+
+struct Job {
+  int size_index;
+  int mix_index;
+  unsigned seed;
+  Outcome outcome;
+};
+
+int main(int argc, char *argv[]) {
+  long long total_operations = 10000000;
+  int per_scenario = 20000;
+  unsigned threads = std::thread::hardware_concurrency();
+  unsigned seed = 1;
+  if (argc > 1) std::sscanf(argv[1], "%lld", &total_operations);
+  if (argc > 2) std::sscanf(argv[2], "%i", &per_scenario);
+  if (argc > 3) std::sscanf(argv[3], "%u", &threads);
+  if (argc > 4) std::sscanf(argv[4], "%u", &seed);
+  if (threads == 0) threads = 1;
+  if (per_scenario < 1) per_scenario = 1;
+
+  // every configuration gets the same number of scenarios, seeds are consecutive
+  long long scenarios = total_operations / per_scenario;
+  long long per_configuration = (scenarios + num_sizes * num_mixes - 1) / (num_sizes * num_mixes);
+  std::vector<Job> jobs;
+  for (int s = 0; s < num_sizes; ++s) {
+    for (int m = 0; m < num_mixes; ++m) {
+      for (long long i = 0; i < per_configuration; ++i) {
+        jobs.push_back(Job{s, m, seed + static_cast<unsigned>(i), Outcome()});
+      }
+    }
+  }
+
+  std::cout << "Running " << jobs.size() << " scenarios of " << per_scenario << " operations on " << threads
+            << " threads" << std::endl;
+
+  std::atomic<size_t> next_job{0};
+  auto worker = [&]() {
+    for (size_t j = next_job++; j < jobs.size(); j = next_job++) {
+      Mix const &mix = mixes[jobs[j].mix_index];
+      LariatScenario sc(
+          per_scenario,
+          2000,
+          mix.f[0],
+          mix.f[1],
+          mix.f[2],
+          mix.f[3],
+          mix.f[4],
+          mix.f[5],
+          mix.f[6],
+          mix.f[7],
+          mix.f[8],
+          jobs[j].seed);
+      jobs[j].outcome = checkers[jobs[j].size_index](sc);
+    }
+  };
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::vector<std::thread> pool;
+  for (unsigned t = 0; t < threads; ++t) {
+    pool.emplace_back(worker);
+  }
+  for (std::thread &t: pool) {
+    t.join();
+  }
+  std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - start;
+
+  // report per configuration
+  int failures = 0;
+  std::cout << std::left << std::setw(6) << "Size" << std::setw(10) << "Mix" << std::right << std::setw(10)
+            << "Scenarios" << std::setw(10) << "Failed" << std::setw(14) << "Ops/s" << std::endl;
+  for (int s = 0; s < num_sizes; ++s) {
+    for (int m = 0; m < num_mixes; ++m) {
+      int count = 0, failed = 0;
+      double seconds = 0;
+      for (Job const &job: jobs) {
+        if (job.size_index != s || job.mix_index != m) continue;
+        ++count;
+        seconds += job.outcome.seconds;
+        if (!job.outcome.ok) {
+          ++failed;
+          std::cerr << "Size " << sizes[s] << " mix " << mixes[m].name << " seed " << job.seed << ": "
+                    << job.outcome.error << std::endl;
+        }
+      }
+      failures += failed;
+      std::cout << std::left << std::setw(6) << sizes[s] << std::setw(10) << mixes[m].name << std::right
+                << std::setw(10) << count << std::setw(10) << failed << std::setw(14)
+                << static_cast<long long>(static_cast<double>(count) * per_scenario / seconds) << std::endl;
+    }
+  }
+
+  std::cout << "Total: " << static_cast<long long>(jobs.size()) * per_scenario << " operations in "
+            << elapsed_seconds.count() << " s, " << failures << " failed scenarios" << std::endl;
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+// Recommends a node size for a workload
+// plays an operation mix or a recorded trace on every compiled Lariat<int, Size> and reports
+// throughput and memory per node size, the fastest and the most memory-efficient one
+// usage:
+//   lariat_tune mix <num_operations> <insert> <erase> <pushback> <pushfront> <popback> <popfront>
+//                   <compact> <index> <find> [seed] [repetitions]
+//   lariat_tune trace <trace> [repetitions]
+#include <algorithm>
+#include <chrono>
+#include <cstdio> /* sscanf */
+#include <cstring> /* strcmp */
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include "scenario.h"
+
+// memory is taken from the allocation counters of stats(), which LARIAT_NO_STATS compiles out
+#ifdef LARIAT_NO_STATS
+  #error "lariat_tune needs the Lariat counters, build it without LARIAT_NO_STATS"
+#endif
+
+struct Sample {
+  int size;
+  double seconds; // median over the repetitions
+  size_t peak_bytes; // most memory held by nodes at any time
+  size_t final_bytes; // memory held by nodes after the last operation
+  size_t final_elements;
+};
+
+// repetitions stop early once a run takes longer than give_up seconds, a node size
+// that is that much slower than the best one is not going to be picked anyway
+template<int nodesize>
+Sample tune(LariatScenario const &sc, int repetitions, double give_up) {
+  Sample sample{nodesize, 0, 0, 0, 0};
+  std::vector<double> times;
+  for (int rep = 0; rep < repetitions && (times.empty() || times.back() < give_up); ++rep) {
+    Lariat<int, nodesize> lar;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    play(lar, sc);
+    std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - start;
+    times.push_back(elapsed_seconds.count());
+
+    // every run plays the same operations, so memory is the same for all of them
+    LariatStats stats = lar.stats();
+    sample.peak_bytes = static_cast<size_t>(stats.peak_nodes) * stats.node_bytes;
+    sample.final_bytes = stats.nodes * stats.node_bytes;
+    sample.final_elements = lar.size();
+  }
+
+  std::sort(times.begin(), times.end());
+  sample.seconds = times[times.size() / 2];
+  std::cerr << "Size " << nodesize << " done\n";
+  return sample;
+}
+
+// the node sizes that are tried, a node size has to be known at compile time
+Sample (*const tuners[])(LariatScenario const &, int, double) = {
+    tune<4096>,
+    tune<2048>,
+    tune<1024>,
+    tune<512>,
+    tune<256>,
+    tune<128>,
+    tune<64>,
+    tune<32>,
+    tune<16>,
+    tune<8>,
+    tune<4>,
+    tune<2>,
+};
+
+// largest node size first, small node sizes are the ones that can be very slow
+std::vector<Sample> tune_all(LariatScenario const &sc, int repetitions) {
+  std::vector<Sample> samples;
+  double best = std::numeric_limits<double>::max();
+  for (auto tuner: tuners) {
+    double give_up = best < std::numeric_limits<double>::max() / 10 ? 10 * best : best;
+    samples.insert(samples.begin(), tuner(sc, repetitions, give_up)); // report in increasing node size
+    best = std::min(best, samples.front().seconds);
+  }
+  return samples;
+}
+
+void report(LariatScenario const &sc, std::vector<Sample> const &samples) {
+  const double operations = static_cast<double>(sc.Get().size());
+
+  std::cout << sc.Get().size() << " operations" << std::endl;
+  std::cout << std::setw(6) << "Size" << std::setw(14) << "Ops/s" << std::setw(14) << "Peak bytes" << std::setw(14)
+            << "Final bytes" << std::setw(14) << "Bytes/elem" << std::endl;
+  for (Sample const &s: samples) {
+    std::cout << std::setw(6) << s.size << std::setw(14) << static_cast<long long>(operations / s.seconds)
+              << std::setw(14) << s.peak_bytes << std::setw(14) << s.final_bytes << std::setw(14)
+              << std::fixed << std::setprecision(2)
+              << (s.final_elements ? static_cast<double>(s.final_bytes) / static_cast<double>(s.final_elements) : 0.0)
+              << std::defaultfloat << std::endl;
+  }
+
+  // ties go to the smaller node size
+  Sample const *fastest = &samples.front(), *smallest = &samples.front();
+  for (Sample const &s: samples) {
+    if (s.seconds < fastest->seconds) fastest = &s;
+    if (s.peak_bytes < smallest->peak_bytes) smallest = &s;
+  }
+  std::cout << "Fastest: Size " << fastest->size << " (" << static_cast<long long>(operations / fastest->seconds)
+            << " ops/s, peak " << fastest->peak_bytes << " bytes)" << std::endl;
+  std::cout << "Most memory-efficient: Size " << smallest->size << " (peak " << smallest->peak_bytes << " bytes, "
+            << static_cast<long long>(operations / smallest->seconds) << " ops/s)" << std::endl;
+}
+
+int from_mix(int argc, char *argv[]) {
+  if (argc < 12 || argc > 14) {
+    std::cerr << "mix needs the number of operations and 9 frequencies\n";
+    return 1;
+  }
+
+  int num_operations = 0, repetitions = 3;
+  unsigned seed = 1;
+  float f[9]{};
+  std::sscanf(argv[2], "%i", &num_operations);
+  for (int i = 0; i < 9; ++i) {
+    std::sscanf(argv[3 + i], "%f", &f[i]);
+  }
+  if (argc > 12) std::sscanf(argv[12], "%u", &seed);
+  if (argc > 13) std::sscanf(argv[13], "%i", &repetitions);
+  if (repetitions < 1) repetitions = 1;
+
+  // same value range as lariat_replay record
+  LariatScenario sc(num_operations, 200000, f[0], f[1], f[2], f[3], f[4], f[5], f[6], f[7], f[8], seed);
+  report(sc, tune_all(sc, repetitions));
+  return 0;
+}
+
+int from_trace(int argc, char *argv[]) {
+  if (argc < 3 || argc > 4) {
+    std::cerr << "trace needs a trace file\n";
+    return 1;
+  }
+
+  std::ifstream trace(argv[2]);
+  if (!trace) {
+    std::cerr << "cannot read " << argv[2] << std::endl;
+    return 1;
+  }
+  LariatScenario sc(trace);
+
+  int repetitions = 3;
+  if (argc > 3) std::sscanf(argv[3], "%i", &repetitions);
+  if (repetitions < 1) repetitions = 1;
+
+  report(sc, tune_all(sc, repetitions));
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  try {
+    if (argc > 1 && std::strcmp(argv[1], "mix") == 0) {
+      return from_mix(argc, argv);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "trace") == 0) {
+      return from_trace(argc, argv);
+    }
+  } catch (LariatException &le) {
+    std::cerr << "Somethingbad happened: " << le.what() << std::endl;
+    return 1;
+  }
+
+  std::cerr << "usage: " << argv[0]
+            << " mix <num_operations> <insert> <erase> <pushback> <pushfront> <popback> <popfront> <compact> <index>"
+               " <find> [seed] [repetitions]\n"
+            << "       " << argv[0] << " trace <trace> [repetitions]\n";
+  return 1;
+}